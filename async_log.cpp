@@ -0,0 +1,296 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#include "async_log.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <easylogging++.h>
+
+std::atomic<int> log_detail::min_level{static_cast<int>(log_severity::DEBUG)};
+
+// A byte ring with one thread pushing and the writer popping. Each line is a 4-byte length, a level byte, then the
+// text; a line may wrap around the end.
+class log_ring
+{
+public:
+    static constexpr size_t capacity = 64 * 1024;
+    static constexpr size_t max_line = capacity / 4;
+    static constexpr size_t header = 5;
+
+    bool try_push(log_severity level, const std::string &text)
+    {
+        uint32_t len = std::min(text.size(), max_line);
+        auto head = head_.load(std::memory_order_relaxed);
+        auto tail = tail_.load(std::memory_order_acquire);
+        if (capacity - (head - tail) < header + len)
+        {
+            return false;
+        }
+
+        char h[header];
+        std::memcpy(h, &len, 4);
+        h[4] = static_cast<char>(level);
+        write_(head, h, header);
+        write_(head + header, text.data(), len);
+        head_.store(head + header + len, std::memory_order_release);
+        return true;
+    }
+
+    template<class F>
+    void drain(F f, std::string &scratch)
+    {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        auto head = head_.load(std::memory_order_acquire);
+        while (tail != head)
+        {
+            char h[header];
+            read_(tail, h, header);
+            uint32_t len;
+            std::memcpy(&len, h, 4);
+            scratch.resize(len);
+            read_(tail + header, &scratch[0], len);
+            tail += header + len;
+            f(static_cast<log_severity>(h[4]), scratch);
+        }
+        tail_.store(tail, std::memory_order_release);
+    }
+
+    bool empty() const
+    { return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire); }
+
+    std::atomic<bool> orphaned{false}; // its thread has exited; it goes once it's empty
+
+private:
+    void write_(size_t at, const char *from, size_t n)
+    {
+        auto offset = at % capacity;
+        auto first = std::min(n, capacity - offset);
+        std::memcpy(buf_ + offset, from, first);
+        std::memcpy(buf_, from + first, n - first);
+    }
+
+    void read_(size_t at, char *to, size_t n) const
+    {
+        auto offset = at % capacity;
+        auto first = std::min(n, capacity - offset);
+        std::memcpy(to, buf_ + offset, first);
+        std::memcpy(to + first, buf_, n - first);
+    }
+
+    // head_ and tail_ count bytes ever written and read, so full and empty can't be confused. They're kept a cache
+    // line apart, as one is only ever written by the logging thread and the other by the writer.
+    std::atomic<size_t> head_{0};
+    char head_padding_[64 - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> tail_{0};
+    char tail_padding_[64 - sizeof(std::atomic<size_t>)];
+    char buf_[capacity];
+};
+
+constexpr size_t log_ring::capacity;
+constexpr size_t log_ring::max_line;
+constexpr size_t log_ring::header;
+
+static std::atomic<bool> async_{false};
+static log_overflow overflow_{log_overflow::drop};
+static std::atomic<uint64_t> dropped_{0};
+
+static std::mutex rings_mutex_;
+static std::vector<std::shared_ptr<log_ring>> rings_;
+
+static std::mutex drain_mutex_; // held by whoever is emptying the rings
+static std::thread writer_;
+static std::atomic<bool> stopping_{false};
+
+static void write_(log_severity level, const std::string &text)
+{
+    auto logger = el::Loggers::getLogger("default");
+    switch (level)
+    {
+        case log_severity::DEBUG:
+            logger->debug("%v", text);
+            break;
+        case log_severity::INFO:
+            logger->info("%v", text);
+            break;
+        case log_severity::WARNING:
+            logger->warn("%v", text);
+            break;
+        case log_severity::ERROR:
+            logger->error("%v", text);
+            break;
+        case log_severity::FATAL:
+            logger->fatal("%v", text);
+            break;
+    }
+}
+
+// This thread's ring, registered with the writer the first time it logs.
+static log_ring &ring_()
+{
+    struct holder
+    {
+        std::shared_ptr<log_ring> ring{std::make_shared<log_ring>()};
+
+        holder()
+        {
+            std::lock_guard<std::mutex> lk{rings_mutex_};
+            rings_.push_back(ring);
+        }
+
+        ~holder()
+        { ring->orphaned = true; }
+    };
+
+    static thread_local holder mine;
+    return *mine.ring;
+}
+
+// With drain_mutex_ held. Returns whether anything was written.
+static bool drain_()
+{
+    std::vector<std::shared_ptr<log_ring>> rings;
+    {
+        std::lock_guard<std::mutex> lk{rings_mutex_};
+        rings = rings_;
+    }
+
+    static std::string scratch;
+    bool wrote = false;
+    for (auto &ring : rings)
+    {
+        ring->drain([&](log_severity level, const std::string &text)
+                    {
+                        write_(level, text);
+                        wrote = true;
+                    }, scratch);
+    }
+
+    // forget rings whose threads have gone and that have nothing left in them
+    std::lock_guard<std::mutex> lk{rings_mutex_};
+    for (auto it = rings_.begin(); it != rings_.end();)
+    {
+        it = ((*it)->orphaned && (*it)->empty()) ? rings_.erase(it) : std::next(it);
+    }
+    return wrote;
+}
+
+static void run_writer_()
+{
+    while (!stopping_.load(std::memory_order_acquire))
+    {
+        bool wrote;
+        {
+            std::lock_guard<std::mutex> lk{drain_mutex_};
+            wrote = drain_();
+        }
+        if (!wrote)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds{5});
+        }
+    }
+}
+
+void start_async_logging(log_overflow overflow)
+{
+    if (async_.exchange(true))
+    {
+        return;
+    }
+    overflow_ = overflow;
+    stopping_ = false;
+    writer_ = std::thread{run_writer_};
+    std::atexit(stop_async_logging);
+}
+
+void stop_async_logging()
+{
+    if (!async_.exchange(false))
+    {
+        return;
+    }
+    stopping_ = true;
+    writer_.join();
+
+    std::lock_guard<std::mutex> lk{drain_mutex_};
+    drain_();
+}
+
+void set_log_level(log_severity min)
+{
+    log_detail::min_level = static_cast<int>(min);
+}
+
+uint64_t log_lines_dropped()
+{
+    return dropped_.load(std::memory_order_relaxed);
+}
+
+std::streambuf::int_type log_line::string_buf::overflow(int_type c)
+{
+    if (c != traits_type::eof())
+    {
+        out_.push_back(static_cast<char>(c));
+    }
+    return c;
+}
+
+std::streamsize log_line::string_buf::xsputn(const char *s, std::streamsize n)
+{
+    out_.append(s, n);
+    return n;
+}
+
+static thread_local std::string line_text_;
+static thread_local bool formatting_ = false;
+
+log_line::log_line(log_severity level) :
+        level_{level},
+        text_{formatting_ ? &own_ : &line_text_},
+        buf_{*text_},
+        stream_{&buf_}
+{
+    text_->clear();
+    formatting_ = true;
+}
+
+log_line::~log_line()
+{
+    if (text_ == &line_text_)
+    {
+        formatting_ = false;
+    }
+
+    if (level_ == log_severity::FATAL || !async_.load(std::memory_order_acquire))
+    {
+        if (level_ == log_severity::FATAL && async_)
+        {
+            // everything that led up to this goes out first
+            std::lock_guard<std::mutex> lk{drain_mutex_};
+            drain_();
+        }
+        write_(level_, *text_);
+        return;
+    }
+
+    auto &ring = ring_();
+    while (!ring.try_push(level_, *text_))
+    {
+        if (overflow_ == log_overflow::drop)
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (!async_.load(std::memory_order_acquire))
+        {
+            write_(level_, *text_); // the writer has stopped, so nobody is coming to make room
+            return;
+        }
+        std::this_thread::yield(); // the writer will be round soon enough
+    }
+}
@@ -0,0 +1,94 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#pragma once
+
+// The backend behind LOG(). Once start_async_logging() has been called, a line is formatted on the thread that logs
+// it into a buffer that thread reuses, then copied into that thread's own ring buffer; a single writer thread empties
+// the rings into easylogging++, so its lock and its I/O never happen on a request thread. Each ring has exactly one
+// writer and one reader, so pushing a line is a couple of atomic loads and a store. When a ring is full the line is
+// either dropped (and counted) or the thread waits for room, whichever was asked for. Lines from different threads
+// can come out slightly out of order. Before start_async_logging(), and after stop_async_logging(), lines go straight
+// to easylogging++ as they always did. FATAL lines always do, once everything ahead of them has been written.
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+enum class log_severity
+{
+    DEBUG,
+    INFO,
+    WARNING,
+    ERROR,
+    FATAL,
+};
+
+enum class log_overflow
+{
+    drop,
+    block,
+};
+
+void start_async_logging(log_overflow overflow);
+
+// Writes out whatever is still buffered and goes back to logging synchronously.
+void stop_async_logging();
+
+// The runtime floor; WALDORF_LOG_MIN_LEVEL in logging.h is the compile-time one.
+void set_log_level(log_severity min);
+
+namespace log_detail
+{
+extern std::atomic<int> min_level;
+}
+
+inline bool log_enabled(log_severity level)
+{ return static_cast<int>(level) >= log_detail::min_level.load(std::memory_order_relaxed); }
+
+uint64_t log_lines_dropped();
+
+// One LOG() statement.
+class log_line
+{
+public:
+    explicit log_line(log_severity level);
+
+    ~log_line();
+
+    std::ostream &stream()
+    { return stream_; }
+
+private:
+    // appends to a string that keeps its capacity from one line to the next
+    class string_buf : public std::streambuf
+    {
+    public:
+        explicit string_buf(std::string &out) : out_(out)
+        {}
+
+    protected:
+        int_type overflow(int_type c) override;
+
+        std::streamsize xsputn(const char *s, std::streamsize n) override;
+
+    private:
+        std::string &out_;
+    };
+
+    log_severity level_;
+    std::string own_;     // only used when a LOG() runs while this thread is already formatting one
+    std::string *text_;
+    string_buf buf_;
+    std::ostream stream_;
+};
+
+// Lets LOG() be a single expression, so it's safe under an unbraced if.
+struct log_voidify
+{
+    void operator&(std::ostream &)
+    {}
+};
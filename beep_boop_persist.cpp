@@ -3,4 +3,567 @@
 //
 
 #include "beep_boop_persist.h"
+#include <algorithm>
+#include "json_scan.h"
+#include "metrics.h"
 
+struct op_metrics_
+{
+    metric_histogram &latency;
+    metric_counter &failures;
+};
+
+static op_metrics_ op_metrics_for_(const std::string &op)
+{
+    auto label = "op=\"" + op + "\"";
+    return {metrics().histogram("waldorf_persist_seconds", "Time taken by beep_boop_persist operations", label),
+            metrics().counter("waldorf_persist_failures_total", "beep_boop_persist operations that failed", label)};
+}
+
+static std::string join_keys_(const std::vector<std::string> &keys)
+{
+    std::string joined;
+    for (const auto &key : keys)
+    {
+        if (!joined.empty()) joined += ",";
+        joined += key;
+    }
+    return joined;
+}
+
+beep_boop_persist::beep_boop_persist(const std::string &url,
+                                     const std::string &token,
+                                     const std::string &log_path,
+                                     std::chrono::milliseconds log_sync_interval,
+                                     size_t io_threads) :
+        url_{url}, header_{{"Authorization", "Bearer " + token}}, backend_{backend::remote},
+        io_{new executor{io_threads, io_threads * 64}},
+        write_behind_{false},
+        max_pending_{0},
+        flush_interval_{0},
+        stopping_{false}
+{
+    if (!log_path.empty())
+    {
+        log_store_.reset(new log_store{log_path, log_sync_interval});
+        if (log_store_->ok())
+        {
+            backend_ = backend::local_log;
+            LOG(DEBUG) << "beep_boop_persist: Using local log store at " << log_path;
+            return;
+        }
+        log_store_.reset();
+        LOG(WARNING) << "beep_boop_persist: Can't use local log store at " << log_path;
+    }
+
+    if (url.empty())
+    {
+        backend_ = backend::memory;
+        LOG(DEBUG) << "beep_boop_persist: Using in-memory store";
+    }
+}
+
+bool beep_boop_persist::get_(const std::string &key, std::string &value) const
+{
+    static auto m = op_metrics_for_("get");
+    scoped_timer timer{m.latency};
+
+    switch (backend_)
+    {
+        case backend::memory:
+            return mem_store_.get(key, value);
+        case backend::local_log:
+            return log_store_->get(key, value);
+        case backend::remote:
+            break;
+    }
+
+    auto resp = cpr::Get(url_ + "/persist/kv" + key, header_);
+    if (resp.status_code != 200)
+    {
+        m.failures.add();
+        LOG(WARNING) << "KV GET failure " << resp.status_code << " " << resp.text;
+        return false;
+    }
+
+    value = resp.text;
+    return true;
+}
+
+bool beep_boop_persist::set_(const std::string &key, const std::string &value)
+{
+    static auto m = op_metrics_for_("set");
+    scoped_timer timer{m.latency};
+
+    if (key.empty()) return false;
+
+    switch (backend_)
+    {
+        case backend::memory:
+            mem_store_.set(key, value);
+            return true;
+        case backend::local_log:
+            if (!log_store_->set(key, value))
+            {
+                m.failures.add();
+                return false;
+            }
+            return true;
+        case backend::remote:
+            break;
+    }
+
+    auto my_headers = header_;
+    my_headers["Content-Type"] = "application/json";
+    auto resp = cpr::Put(url_ + "/persist/kv" + key, my_headers, cpr::Body{value});
+    if (resp.status_code != 200)
+    {
+        m.failures.add();
+        LOG(WARNING) << "KV PUT failure " << resp.status_code << " " << resp.text;
+        return false;
+    }
+
+    return true;
+}
+
+bool beep_boop_persist::erase_(const std::string &key)
+{
+    static auto m = op_metrics_for_("erase");
+    scoped_timer timer{m.latency};
+
+    if (key.empty()) return false;
+
+    switch (backend_)
+    {
+        case backend::memory:
+            mem_store_.erase(key);
+            return true;
+        case backend::local_log:
+            if (!log_store_->erase(key))
+            {
+                m.failures.add();
+                return false;
+            }
+            return true;
+        case backend::remote:
+            break;
+    }
+
+    auto resp = cpr::Delete(url_ + "/persist/kv" + key, header_);
+    if (resp.status_code != 200)
+    {
+        m.failures.add();
+        LOG(WARNING) << "KV DELETE failure " << resp.status_code << " " << resp.text;
+        return false;
+    }
+
+    return true;
+}
+
+bool beep_boop_persist::mget_(const std::vector<std::string> &keys, std::map<std::string, std::string> &values) const
+{
+    static auto m = op_metrics_for_("mget");
+    scoped_timer timer{m.latency};
+
+    if (keys.empty()) return true;
+
+    if (backend_ != backend::remote)
+    {
+        for (const auto &key : keys)
+        {
+            std::string value;
+            if (get_(key, value))
+            {
+                values[key] = std::move(value);
+            }
+        }
+        return true;
+    }
+
+    // The values come back as a JSON array in the same order as the keys, with null for the ones that aren't set.
+    auto resp = cpr::Get(url_ + "/persist/mget", header_, cpr::Parameters{{"keys", join_keys_(keys)}});
+    if (resp.status_code != 200)
+    {
+        m.failures.add();
+        LOG(WARNING) << "KV MGET failure " << resp.status_code << " " << resp.text;
+        return false;
+    }
+
+    json_scanner scanner{resp.text};
+    if (!scanner.enter_array())
+    {
+        m.failures.add();
+        LOG(WARNING) << "KV MGET failure, unexpected response " << resp.text;
+        return false;
+    }
+
+    size_t i = 0;
+    while (scanner.next_element() && i < keys.size())
+    {
+        string_view value;
+        if (scanner.peek() == 'n')
+        {
+            scanner.skip_value();
+        }
+        else if (scanner.read_raw_value(value))
+        {
+            values[keys[i]] = value.to_string();
+        }
+        ++i;
+    }
+
+    if (!scanner.ok())
+    {
+        m.failures.add();
+        LOG(WARNING) << "KV MGET failure, unexpected response " << resp.text;
+        return false;
+    }
+
+    return true;
+}
+
+bool beep_boop_persist::mset_(const std::map<std::string, std::string> &values)
+{
+    static auto m = op_metrics_for_("mset");
+    scoped_timer timer{m.latency};
+
+    if (values.empty()) return true;
+
+    if (backend_ != backend::remote)
+    {
+        // keep going past a failure, so that as much as possible gets written, but report it
+        bool ok = true;
+        for (const auto &kv : values)
+        {
+            ok = set_(kv.first, kv.second) && ok;
+        }
+        return ok;
+    }
+
+    // Values are JSON documents, just as with set(), so they go into the batch as they are.
+    std::string body{"["};
+    for (const auto &kv : values)
+    {
+        if (kv.first.empty()) continue;
+        if (body.size() > 1) body += ",";
+        body += "{\"key\":";
+        append_json_string(body, kv.first);
+        body += ",\"value\":";
+        body += kv.second;
+        body += "}";
+    }
+    body += "]";
+
+    auto my_headers = header_;
+    my_headers["Content-Type"] = "application/json";
+    auto resp = cpr::Put(url_ + "/persist/mset", my_headers, cpr::Body{body});
+    if (resp.status_code != 200)
+    {
+        m.failures.add();
+        LOG(WARNING) << "KV MSET failure " << resp.status_code << " " << resp.text;
+        return false;
+    }
+
+    return true;
+}
+
+bool beep_boop_persist::merase_(const std::vector<std::string> &keys)
+{
+    static auto m = op_metrics_for_("merase");
+    scoped_timer timer{m.latency};
+
+    if (keys.empty()) return true;
+
+    if (backend_ != backend::remote)
+    {
+        bool ok = true;
+        for (const auto &key : keys)
+        {
+            ok = erase_(key) && ok;
+        }
+        return ok;
+    }
+
+    auto resp = cpr::Delete(url_ + "/persist/mdel", header_, cpr::Parameters{{"keys", join_keys_(keys)}});
+    if (resp.status_code != 200)
+    {
+        m.failures.add();
+        LOG(WARNING) << "KV MDELETE failure " << resp.status_code << " " << resp.text;
+        return false;
+    }
+
+    return true;
+}
+
+beep_boop_persist::~beep_boop_persist()
+{
+    drain();
+}
+
+bool beep_boop_persist::drain()
+{
+    // run whatever async writes are still queued first, so that they're pending in time for the last flush
+    io_->shutdown();
+
+    if (!write_behind_)
+    {
+        return true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lk{pending_mutex_};
+        stopping_ = true;
+    }
+    pending_cv_.notify_all();
+    if (flusher_.joinable())
+    {
+        flusher_.join();
+    }
+
+    // a last few goes at whatever is left before we give up on it
+    for (int attempt = 0; attempt < 3 && !flush(); ++attempt)
+    {
+        std::this_thread::sleep_for(flush_interval_);
+    }
+    if (pending_writes())
+    {
+        LOG(ERROR) << "beep_boop_persist: lost " << pending_writes() << " pending writes on shutdown";
+        return false;
+    }
+    return true;
+}
+
+void beep_boop_persist::enable_write_behind(size_t max_pending, std::chrono::milliseconds flush_interval)
+{
+    if (write_behind_)
+    {
+        return;
+    }
+
+    write_behind_ = true;
+    max_pending_ = max_pending ? max_pending : 1;
+    flush_interval_ = std::max(flush_interval, std::chrono::milliseconds{1});
+    flusher_ = std::thread{&beep_boop_persist::run_write_behind_, this};
+    LOG(DEBUG) << "beep_boop_persist: Buffering writes, flushing every " << flush_interval.count() << "ms or "
+               << max_pending_ << " keys";
+}
+
+size_t beep_boop_persist::pending_writes() const
+{
+    std::lock_guard<std::mutex> lk{pending_mutex_};
+    return pending_.size() + in_flight_.size();
+}
+
+bool beep_boop_persist::pending_get_(const std::string &key, bool &found, std::string &value) const
+{
+    std::lock_guard<std::mutex> lk{pending_mutex_};
+    for (const auto *writes : {&pending_, &in_flight_}) // newest first
+    {
+        auto it = writes->find(key);
+        if (it != writes->end())
+        {
+            found = !it->second.erase;
+            if (found)
+            {
+                value = it->second.value;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void beep_boop_persist::pend_(const std::string &key, bool erase, const std::string &value)
+{
+    bool full;
+    {
+        std::lock_guard<std::mutex> lk{pending_mutex_};
+        auto &write = pending_[key];
+        write.erase = erase;
+        write.value = erase ? std::string{} : value;
+        full = pending_.size() >= max_pending_;
+    }
+    if (full)
+    {
+        pending_cv_.notify_one();
+    }
+}
+
+bool beep_boop_persist::get(const std::string &key, std::string &value) const
+{
+    bool found;
+    if (write_behind_ && pending_get_(key, found, value))
+    {
+        return found;
+    }
+    return get_(key, value);
+}
+
+bool beep_boop_persist::set(const std::string &key, const std::string &value)
+{
+    if (key.empty()) return false;
+
+    if (write_behind_)
+    {
+        pend_(key, false, value);
+        return true;
+    }
+    return set_(key, value);
+}
+
+bool beep_boop_persist::erase(const std::string &key)
+{
+    if (key.empty()) return false;
+
+    if (write_behind_)
+    {
+        pend_(key, true, {});
+        return true;
+    }
+    return erase_(key);
+}
+
+bool beep_boop_persist::mget(const std::vector<std::string> &keys, std::map<std::string, std::string> &values) const
+{
+    if (!write_behind_)
+    {
+        return mget_(keys, values);
+    }
+
+    std::vector<std::string> stored_keys;
+    for (const auto &key : keys)
+    {
+        bool found;
+        std::string value;
+        if (!pending_get_(key, found, value))
+        {
+            stored_keys.push_back(key);
+        }
+        else if (found)
+        {
+            values[key] = std::move(value);
+        }
+    }
+    return mget_(stored_keys, values);
+}
+
+bool beep_boop_persist::mset(const std::map<std::string, std::string> &values)
+{
+    if (!write_behind_)
+    {
+        return mset_(values);
+    }
+
+    for (const auto &kv : values)
+    {
+        set(kv.first, kv.second);
+    }
+    return true;
+}
+
+bool beep_boop_persist::merase(const std::vector<std::string> &keys)
+{
+    if (!write_behind_)
+    {
+        return merase_(keys);
+    }
+
+    for (const auto &key : keys)
+    {
+        erase(key);
+    }
+    return true;
+}
+
+bool beep_boop_persist::flush()
+{
+    if (!write_behind_)
+    {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> flush_lk{flush_mutex_}; // after the flusher, if it's mid-batch
+    return flush_pending_();
+}
+
+bool beep_boop_persist::flush_pending_()
+{
+    pending_writes_t batch;
+    {
+        std::lock_guard<std::mutex> lk{pending_mutex_};
+        batch.swap(pending_);
+        in_flight_ = batch;
+    }
+    return flush_(batch);
+}
+
+bool beep_boop_persist::flush_(pending_writes_t &batch)
+{
+    if (batch.empty())
+    {
+        return true;
+    }
+
+    std::map<std::string, std::string> sets;
+    std::vector<std::string> erases;
+    for (auto &write : batch)
+    {
+        if (write.second.erase)
+        {
+            erases.push_back(write.first);
+        }
+        else
+        {
+            sets[write.first] = write.second.value;
+        }
+    }
+
+    bool sets_ok = mset_(sets);
+    bool erases_ok = merase_(erases);
+
+    std::lock_guard<std::mutex> lk{pending_mutex_};
+    in_flight_.clear();
+    if (sets_ok && erases_ok)
+    {
+        return true;
+    }
+
+    // Put the failed half back for the next go, unless a newer write to the same key has come in since.
+    for (auto &write : batch)
+    {
+        if ((write.second.erase && !erases_ok) || (!write.second.erase && !sets_ok))
+        {
+            pending_.emplace(write.first, std::move(write.second));
+        }
+    }
+    LOG(WARNING) << "beep_boop_persist: flush failed, " << pending_.size() << " writes waiting to retry";
+    return false;
+}
+
+void beep_boop_persist::run_write_behind_()
+{
+    auto backoff = flush_interval_;
+    std::unique_lock<std::mutex> lk{pending_mutex_};
+    while (!stopping_)
+    {
+        bool failing = backoff > flush_interval_;
+        pending_cv_.wait_for(lk, backoff, [&]
+        { return stopping_ || (!failing && pending_.size() >= max_pending_); });
+        if (stopping_)
+        {
+            break;
+        }
+
+        lk.unlock();
+        bool ok;
+        {
+            std::lock_guard<std::mutex> flush_lk{flush_mutex_};
+            ok = flush_pending_();
+        }
+
+        // back off while the store is failing, up to a limit, so we aren't hammering it
+        backoff = ok ? flush_interval_ : std::min(backoff * 2, std::chrono::milliseconds{5000});
+
+        lk.lock();
+    }
+}
@@ -7,109 +7,180 @@
 // There are far more clever ways to do this. I'd like to use the subscript operator with a custom member class
 // so you could use this just like a hash map. But, hey, that can come later.
 
-#include <string>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 #include <cpr/cpr.h>
+#include "executor.h"
+#include "log_store.h"
+#include "sharded_map.h"
 #include "logging.h"
 
 class beep_boop_persist
 {
 public:
-    beep_boop_persist(const std::string &url, const std::string &token) :
-            url_{url}, header_{{"Authorization", "Bearer " + token}}
+    // found, value
+    using maybe_value = std::pair<bool, std::string>;
+
+    // With a log_path, keys live in a local log_store; otherwise with a url, in Beep Boop's KV service; otherwise
+    // just in memory.
+    beep_boop_persist(const std::string &url,
+                      const std::string &token,
+                      const std::string &log_path = "",
+                      std::chrono::milliseconds log_sync_interval = std::chrono::milliseconds{50},
+                      size_t io_threads = 4);
+
+    ~beep_boop_persist();
+
+    // Write-behind mode: set, erase, mset and merase only record the write and return; a background thread coalesces
+    // repeated writes to the same key and flushes them in batches, whenever max_pending keys are waiting or every
+    // flush_interval, whichever comes first. Reads see pending writes straight away. A failed flush is put back and
+    // retried, and whatever is still pending is flushed on destruction.
+    void enable_write_behind(size_t max_pending, std::chrono::milliseconds flush_interval);
+
+    // True when nobody but us reads what's stored, so it needn't be JSON.
+    bool is_local() const
+    { return backend_ != backend::remote; }
+
+    // Flush pending writes now, after any flush already under way; returns false if any of them couldn't be written.
+    bool flush();
+
+    size_t pending_writes() const;
+
+    // On the way down: runs every async operation still queued, stops the write-behind flusher and flushes whatever
+    // it left. Async operations run on the calling thread from then on. Returns false if some writes were lost.
+    bool drain();
+
+    bool get(const std::string &key, std::string &value) const;
+
+    bool set(const std::string &key, const std::string &value);
+
+    bool erase(const std::string &key);
+
+    // Batched versions, one round trip each. Keys that aren't in the store are simply missing from mget's result.
+    bool mget(const std::vector<std::string> &keys, std::map<std::string, std::string> &values) const;
+
+    bool mset(const std::map<std::string, std::string> &values);
+
+    bool merase(const std::vector<std::string> &keys);
+
+    // Asynchronous versions of all of the above, run on the store's own I/O threads so that callers can get on with
+    // something else (like talking to Slack) in the meantime. When the I/O queue is full the operation just runs
+    // right away on the calling thread.
+    std::future<maybe_value> get_async(const std::string &key) const
+    { return async_([=] { std::string value; bool found = get(key, value); return maybe_value{found, value}; }); }
+
+    void get_async(const std::string &key, std::function<void(bool, const std::string &)> done) const
+    { async_([=] { std::string value; bool found = get(key, value); done(found, value); }); }
+
+    std::future<bool> set_async(const std::string &key, const std::string &value)
+    { return async_([=] { return set(key, value); }); }
+
+    void set_async(const std::string &key, const std::string &value, std::function<void(bool)> done)
+    { async_([=] { done(set(key, value)); }); }
+
+    std::future<bool> erase_async(const std::string &key)
+    { return async_([=] { return erase(key); }); }
+
+    void erase_async(const std::string &key, std::function<void(bool)> done)
+    { async_([=] { done(erase(key)); }); }
+
+    std::future<std::map<std::string, std::string>> mget_async(const std::vector<std::string> &keys) const
+    { return async_([=] { std::map<std::string, std::string> values; mget(keys, values); return values; }); }
+
+    void mget_async(const std::vector<std::string> &keys,
+                    std::function<void(bool, const std::map<std::string, std::string> &)> done) const
+    { async_([=] { std::map<std::string, std::string> values; bool ok = mget(keys, values); done(ok, values); }); }
+
+    std::future<bool> mset_async(const std::map<std::string, std::string> &values)
+    { return async_([=] { return mset(values); }); }
+
+    void mset_async(const std::map<std::string, std::string> &values, std::function<void(bool)> done)
+    { async_([=] { done(mset(values)); }); }
+
+    std::future<bool> merase_async(const std::vector<std::string> &keys)
+    { return async_([=] { return merase(keys); }); }
+
+    void merase_async(const std::vector<std::string> &keys, std::function<void(bool)> done)
+    { async_([=] { done(merase(keys)); }); }
+
+private:
+    template<class F>
+    auto async_(F &&work) const -> std::future<decltype(work())>
     {
-        if (url.empty())
+        auto job = std::make_shared<std::packaged_task<decltype(work())()>>(std::forward<F>(work));
+        auto result = job->get_future();
+        executor::task t = [job]
+        { (*job)(); };
+        if (!io_->try_submit(t))
         {
-            in_memory_ = true;
-            LOG(DEBUG) << "beep_boop_persist: Using in-memory store";
+            (*job)();
         }
+        return result;
     }
 
-    ~beep_boop_persist()
-    {}
-
-    template<class K>
-    bool get(K &&key, std::string &value) const
+    struct pending_write
     {
-        if (in_memory_)
-        {
-            if (mem_store_.count(key))
-            {
-                value = mem_store_.at(key);
-                return true;
-            }
-            else
-            {
-                return false;
-            }
-        }
+        bool erase;
+        std::string value;
+    };
 
-        auto resp = cpr::Get(url_ + "/persist/kv" + key, header_);
-        if (resp.status_code != 200)
-        {
-            LOG(WARNING) << "KV GET failure " << resp.status_code << " " << resp.text;
-            return false;
-        }
+    using pending_writes_t = std::map<std::string, pending_write>;
 
-        value = resp.text;
-        return true;
-    }
+    bool get_(const std::string &key, std::string &value) const;
 
-//    template<class Ks>
-//    std::string mget(Ks &&keys...) const
-//    {
-//        auto resp = cpr::get(url_+"/persist/kv"+key, header_);
-//        return resp.text;
-//    }
+    bool set_(const std::string &key, const std::string &value);
 
-    template<class K, class V>
-    bool set(K &&key, V &&value)
-    {
-        if (key.empty()) return false;
+    bool erase_(const std::string &key);
 
-        if (in_memory_)
-        {
-            mem_store_[key] = value;
-            return true;
-        }
+    bool mget_(const std::vector<std::string> &keys, std::map<std::string, std::string> &values) const;
 
-        auto my_headers = header_;
-        my_headers["Content-Type"] = "application/json";
-        auto resp = cpr::Put(url_ + "/persist/kv" + key, my_headers, cpr::Body{value});
-        if (resp.status_code != 200)
-        {
-            LOG(WARNING) << "KV PUT failure " << resp.status_code << " " << resp.text;
-            return false;
-        }
+    bool mset_(const std::map<std::string, std::string> &values);
 
-        return true;
-    };
+    bool merase_(const std::vector<std::string> &keys);
 
-    template<class K>
-    bool erase(K &&key)
-    {
-        if (key.empty()) return "";
+    // If there's a pending write for key, says what a read would see.
+    bool pending_get_(const std::string &key, bool &found, std::string &value) const;
 
-        if (in_memory_)
-        {
-            mem_store_.erase(key);
-            return true;
-        }
+    void pend_(const std::string &key, bool erase, const std::string &value);
 
-        auto resp = cpr::Delete(url_ + "/persist/kv" + key, header_);
-        if (resp.status_code != 200)
-        {
-            LOG(WARNING) << "KV DELETE failure " << resp.status_code << " " << resp.text;
-            return false;
-        }
+    // With flush_mutex_ held.
+    bool flush_pending_();
 
-        return true;
-    }
+    bool flush_(pending_writes_t &batch);
+
+    void run_write_behind_();
+
+    enum class backend
+    {
+        remote,
+        memory,
+        local_log,
+    };
 
-private:
     cpr::Url url_;
     cpr::Header header_;
-    bool in_memory_;
-    std::map<std::string, std::string> mem_store_;
+    backend backend_;
+    sharded_map mem_store_;
+    std::unique_ptr<log_store> log_store_;
+    std::unique_ptr<executor> io_;
+
+    bool write_behind_;
+    size_t max_pending_;
+    std::chrono::milliseconds flush_interval_;
+    std::mutex flush_mutex_; // one flush at a time, so that only one owns in_flight_; taken before pending_mutex_
+    mutable std::mutex pending_mutex_;
+    std::condition_variable pending_cv_;
+    pending_writes_t pending_;   // not yet picked up by the flusher
+    pending_writes_t in_flight_; // being flushed right now; still visible to reads
+    bool stopping_;
+    std::thread flusher_;
 };
-
@@ -0,0 +1,54 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#include "alloc_counter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <malloc.h>
+
+static thread_local size_t allocations_ = 0;
+static std::atomic<size_t> total_allocations_{0};
+static std::atomic<size_t> live_bytes_{0};
+
+size_t thread_allocations()
+{
+    return allocations_;
+}
+
+size_t total_allocations()
+{
+    return total_allocations_.load(std::memory_order_relaxed);
+}
+
+size_t live_heap_bytes()
+{
+    return live_bytes_.load(std::memory_order_relaxed);
+}
+
+void *operator new(size_t size)
+{
+    ++allocations_;
+    total_allocations_.fetch_add(1, std::memory_order_relaxed);
+    if (auto p = std::malloc(size ? size : 1))
+    {
+        live_bytes_.fetch_add(malloc_usable_size(p), std::memory_order_relaxed);
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void *p) noexcept
+{
+    if (p)
+    {
+        live_bytes_.fetch_sub(malloc_usable_size(p), std::memory_order_relaxed);
+    }
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    operator delete(p);
+}
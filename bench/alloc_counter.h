@@ -0,0 +1,18 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#pragma once
+
+// The benchmarks replace the global operator new, so that they can count what a piece of code asks of the heap.
+
+#include <cstddef>
+
+// Allocations made by this thread so far.
+size_t thread_allocations();
+
+// And by every thread.
+size_t total_allocations();
+
+// Bytes on the heap right now, across all threads, counting what malloc actually handed out.
+size_t live_heap_bytes();
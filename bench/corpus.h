@@ -0,0 +1,104 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#pragma once
+
+// A rough stand-in for a day in #random: mostly chatter, the odd emoji, and every now and then one of Statler's lines.
+
+#include <string>
+#include <vector>
+#include "../json_scan.h"
+
+inline const std::vector<std::string> &message_corpus()
+{
+    static const std::vector<std::string> corpus = [] {
+        const std::vector<std::string> chatter = {
+                "morning all",
+                "anyone up for lunch at noon?",
+                ":coffee:",
+                "lol",
+                "Did anyone else see the deploy go out last night? Staging looks a little weird to me.",
+                "I'll be out tomorrow, ping me on my phone if something catches fire",
+                "<@U0JFHT99N> can you take a look at https://github.com/DEGoodmanWilson/waldorfbot/pull/12 when you get a sec",
+                "+1",
+                "Does anyone know the wifi password for the third floor?",
+                "brb",
+                "The build is green again :tada:",
+                "I wonder if there really is life on another planet?",
+                "Boo",
+                "that was the worst thing i've ever heard",
+                "Who took my stapler",
+                "Oh, yeah? Prove it.",
+        };
+        const std::vector<std::string> statler = {
+                "Boo!",
+                "Oh, yeah?",
+                "More! More!",
+                "Why is that?",
+                ":eyes:",
+                "I wonder if anybody reads this channel besides us?",
+                "You know, I think they were trying to make a point with that comment.",
+        };
+
+        std::vector<std::string> messages;
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            // roughly one in twenty messages is part of the act
+            if (i % 20 == 0)
+            {
+                messages.push_back(statler[(i / 20) % statler.size()]);
+            }
+            else
+            {
+                messages.push_back(chatter[i % chatter.size()]);
+            }
+        }
+        return messages;
+    }();
+
+    return corpus;
+}
+
+// The same day as Slack delivers it: each message wrapped in an Events API envelope, with the odd bot message, channel
+// join and event type we don't subscribe to mixed in.
+inline const std::vector<std::string> &event_corpus()
+{
+    static const std::vector<std::string> corpus = [] {
+        const auto &messages = message_corpus();
+        std::vector<std::string> events;
+        for (size_t i = 0; i < messages.size(); ++i)
+        {
+            std::string event;
+            if (i % 20 == 0)
+            {
+                event = R"({"type":"message","subtype":"bot_message","bot_id":"B0FL18L8H","username":"statler",)"
+                        R"("channel":"C2147483705","text":)";
+                append_json_string(event, messages[i]);
+            }
+            else if (i % 50 == 7)
+            {
+                event = R"({"type":"message","subtype":"channel_join","user":"U2147483697","channel":"C2147483705",)"
+                        R"("text":"<@U2147483697|cal> has joined the channel")";
+            }
+            else if (i % 50 == 13)
+            {
+                event = R"({"type":"reaction_added","user":"U2147483697","reaction":"thumbsup",)"
+                        R"("item":{"type":"message","channel":"C2147483705","ts":"1360782400.498405"})";
+            }
+            else
+            {
+                event = R"({"type":"message","user":"U2147483697","channel":"C2147483705","text":)";
+                append_json_string(event, messages[i]);
+            }
+            event += R"(,"ts":"1355517523.000005","event_ts":"1355517523.000005"})";
+
+            events.push_back(R"({"token":"XXYYZZ","team_id":"T0JFHT99N","api_app_id":"A0MDYCDME","event":)" + event +
+                             R"(,"type":"event_callback","authed_users":["U0JFJ3K8A"],"event_id":"Ev)" +
+                             std::to_string(100000 + i) + R"(","event_time":1355517523})");
+        }
+        return events;
+    }();
+
+    return corpus;
+}
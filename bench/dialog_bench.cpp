@@ -0,0 +1,113 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#include <benchmark/benchmark.h>
+#include <regex>
+#include "../dialog.h"
+#include "corpus.h"
+
+// The triggers exactly as they used to be registered with http_event_client::hears(), which runs every one of them
+// against every message.
+static std::vector<std::regex> hears_chain_()
+{
+    static const std::vector<std::string> patterns = {
+            "^I wonder if there really is life on another planet.$",
+            "^Waldorf, the bunny ran away!$",
+            "^Boo!$",
+            "^That was the worst thing I’ve ever heard!$",
+            "^Horrendous!$",
+            "^Oh, yeah\\?$",
+            "^Well, I liked a lot of it.$",
+            "^It was great!$",
+            "^Yeah, bravo!$",
+            "^Hm. Do you think this channel is educational\\?$",
+            "^He was doing okay until he left the channel.$",
+            "^I liked that last message.$",
+            "^Why is that\\?$",
+            "^I'm going to see my lawyer!$",
+            "^You gave him a one\\?$",
+            "^You know, the older I get, the more I appreciate good wit.$",
+            "^That really offended me. I'm a student of Shakespeare.$",
+            "^I love it! I love it!$",
+            "^More! More!$",
+            "^You plan to like this channel\\?$",
+            "^\"Beach Blanket Frankenstein\".$",
+            "^Terrible film!$",
+            "^:eyes:$",
+            "^Wonderful.$",
+            "^How do _we read_ it\\?$",
+            "^I don't believe it! They've managed the impossible! What an achievement! Bravo, bravo!$",
+            "^Well, what ails ya\\?$",
+            "^Did you like it\\?$",
+            "^I wonder if anybody reads this channel besides us\\?$",
+            "^What's wrong with you\\?$",
+            "^Why indigestion\\?$",
+            "^You know, I think they were trying to make a point with that comment.$",
+            "^You know, that was almost funny.$",
+            "^Are you ready for the end of the world\\?$",
+    };
+
+    std::vector<std::regex> chain;
+    for (const auto &pattern : patterns)
+    {
+        chain.emplace_back(pattern);
+    }
+    return chain;
+}
+
+static void BM_hears_chain(benchmark::State &state)
+{
+    const auto chain = hears_chain_();
+    const auto &corpus = message_corpus();
+    size_t fired = 0;
+
+    for (auto _ : state)
+    {
+        for (const auto &message : corpus)
+        {
+            for (const auto &trigger : chain)
+            {
+                if (std::regex_search(message, trigger))
+                {
+                    ++fired;
+                }
+            }
+        }
+    }
+
+    benchmark::DoNotOptimize(fired);
+    state.SetItemsProcessed(state.iterations() * corpus.size());
+}
+BENCHMARK(BM_hears_chain);
+
+static void BM_dialog_match(benchmark::State &state)
+{
+    const auto d = default_dialog();
+    const auto &corpus = message_corpus();
+    size_t fired = 0;
+
+    for (auto _ : state)
+    {
+        for (const auto &message : corpus)
+        {
+            if (d.match(message))
+            {
+                ++fired;
+            }
+        }
+    }
+
+    benchmark::DoNotOptimize(fired);
+    state.SetItemsProcessed(state.iterations() * corpus.size());
+}
+BENCHMARK(BM_dialog_match);
+
+static void BM_dialog_compile(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(default_dialog());
+    }
+}
+BENCHMARK(BM_dialog_compile);
@@ -0,0 +1,55 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+// Getting from a raw envelope to a decision: the full parse and dispatch that http_event_client::handle_event does,
+// against the sniff the route now does first.
+
+#include <benchmark/benchmark.h>
+#include <slack/slack.h>
+#include "../event_sniff.h"
+#include "corpus.h"
+
+static void BM_handle_event(benchmark::State &state)
+{
+    const auto &events = event_corpus();
+    slack::token token{"T0JFHT99N", "xoxp-1234", "U0JFHT99N", "xoxb-1234", "U0JFJ3K8A", "B0JFJ3K89"};
+
+    slack::http_event_client handler{""};
+    size_t handled = 0;
+    handler.on_error([](std::string, std::string)
+                     {});
+    handler.on<slack::event::message>([&](std::shared_ptr<slack::event::message>, const slack::http_event_envelope &)
+                                      { ++handled; });
+    handler.on<slack::event::message_channel_join>([&](std::shared_ptr<slack::event::message_channel_join>,
+                                                       const slack::http_event_envelope &)
+                                                   { ++handled; });
+    handler.on<slack::event::unknown>([&](std::shared_ptr<slack::event::unknown>, const slack::http_event_envelope &)
+                                      { ++handled; });
+
+    for (auto _ : state)
+    {
+        for (const auto &event : events)
+        {
+            benchmark::DoNotOptimize(handler.handle_event(event, token));
+        }
+    }
+    benchmark::DoNotOptimize(handled);
+    state.SetItemsProcessed(state.iterations() * events.size());
+}
+BENCHMARK(BM_handle_event);
+
+static void BM_sniff_event(benchmark::State &state)
+{
+    const auto &events = event_corpus();
+    for (auto _ : state)
+    {
+        for (const auto &event : events)
+        {
+            sniffed_event sniffed;
+            benchmark::DoNotOptimize(sniff_event(event, sniffed));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * events.size());
+}
+BENCHMARK(BM_sniff_event);
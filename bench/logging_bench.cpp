@@ -0,0 +1,62 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+// What a LOG() line costs the thread that logs it: straight into easylogging++ as it used to, through the async
+// backend, and at a level that's switched off. easylogging++ is told not to print anything, so these measure the
+// logging machinery rather than the terminal.
+
+#include <benchmark/benchmark.h>
+#include <sstream>
+#include "../logging.h"
+
+static void quiet_()
+{
+    static bool once = []
+    {
+        el::Loggers::reconfigureAllLoggers(el::ConfigurationType::ToStandardOutput, "false");
+        el::Loggers::reconfigureAllLoggers(el::ConfigurationType::ToFile, "false");
+        return true;
+    }();
+    (void) once;
+}
+
+static void BM_log_easylogging(benchmark::State &state)
+{
+    quiet_();
+    for (auto _ : state)
+    {
+        std::ostringstream line;
+        line << "users.list failure " << 429 << " " << "ratelimited";
+        el::Loggers::getLogger("default")->warn("%v", line.str());
+    }
+}
+BENCHMARK(BM_log_easylogging)->ThreadRange(1, 16);
+
+static void BM_log_async(benchmark::State &state)
+{
+    quiet_();
+    static bool started = []
+    {
+        start_async_logging(log_overflow::block);
+        return true;
+    }();
+    (void) started;
+
+    for (auto _ : state)
+    {
+        LOG(WARNING) << "users.list failure " << 429 << " " << "ratelimited";
+    }
+}
+BENCHMARK(BM_log_async)->ThreadRange(1, 16);
+
+static void BM_log_disabled(benchmark::State &state)
+{
+    set_log_level(log_severity::INFO);
+    for (auto _ : state)
+    {
+        LOG(DEBUG) << "Ignoring redelivered event " << "Ev0PV52K21";
+    }
+    set_log_level(log_severity::DEBUG);
+}
+BENCHMARK(BM_log_disabled);
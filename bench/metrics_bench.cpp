@@ -0,0 +1,39 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+// What recording a metric costs on the hot path, alone and with every thread recording into the same metric.
+
+#include <benchmark/benchmark.h>
+#include "../metrics.h"
+
+static void BM_counter_add(benchmark::State &state)
+{
+    static auto &counter = metrics().counter("bench_counter_total", "bench");
+    for (auto _ : state)
+    {
+        counter.add();
+    }
+}
+BENCHMARK(BM_counter_add)->ThreadRange(1, 16);
+
+static void BM_histogram_observe(benchmark::State &state)
+{
+    static auto &histogram = metrics().histogram("bench_seconds", "bench");
+    std::chrono::nanoseconds elapsed{1500000};
+    for (auto _ : state)
+    {
+        histogram.observe(elapsed);
+    }
+}
+BENCHMARK(BM_histogram_observe)->ThreadRange(1, 16);
+
+static void BM_scoped_timer(benchmark::State &state)
+{
+    static auto &histogram = metrics().histogram("bench_timer_seconds", "bench");
+    for (auto _ : state)
+    {
+        scoped_timer timer{histogram};
+    }
+}
+BENCHMARK(BM_scoped_timer)->ThreadRange(1, 16);
@@ -0,0 +1,106 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#include <benchmark/benchmark.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "../beep_boop_persist.h"
+#include "../sharded_map.h"
+
+INITIALIZE_EASYLOGGINGPP
+
+// What the in-memory store used to be, plus the lock it should have had.
+class locked_map
+{
+public:
+    bool get(const std::string &key, std::string &value) const
+    {
+        std::lock_guard<std::mutex> lk{mutex_};
+        auto it = map_.find(key);
+        if (it == map_.end()) return false;
+        value = it->second;
+        return true;
+    }
+
+    void set(const std::string &key, const std::string &value)
+    {
+        std::lock_guard<std::mutex> lk{mutex_};
+        map_[key] = value;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::map<std::string, std::string> map_;
+};
+
+static const std::vector<std::string> &team_ids_()
+{
+    static const std::vector<std::string> ids = []
+    {
+        std::vector<std::string> ids;
+        for (int i = 0; i < 10000; ++i)
+        {
+            ids.push_back("T" + std::to_string(100000000 + i * 7919));
+        }
+        return ids;
+    }();
+    return ids;
+}
+
+static const std::string team_json_{R"({"companion_bot_id":"B0FL18L8H","companion_user_id":"U0FL18L8H"})"};
+
+// Mostly reads with the occasional write, which is how the store gets used once teams are known.
+template<class Map>
+static void stress_(benchmark::State &state, Map &map)
+{
+    const auto &ids = team_ids_();
+    if (state.thread_index() == 0)
+    {
+        for (const auto &id : ids)
+        {
+            map.set(id, team_json_);
+        }
+    }
+
+    std::string value;
+    size_t i = state.thread_index() * 7;
+    for (auto _ : state)
+    {
+        const auto &key = ids[i % ids.size()];
+        if (i % 20 == 0)
+        {
+            map.set(key, team_json_);
+        }
+        else
+        {
+            benchmark::DoNotOptimize(map.get(key, value));
+        }
+        i += 13;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_locked_map(benchmark::State &state)
+{
+    static locked_map map;
+    stress_(state, map);
+}
+BENCHMARK(BM_locked_map)->ThreadRange(1, 16)->UseRealTime();
+
+static void BM_sharded_map(benchmark::State &state)
+{
+    static sharded_map map;
+    stress_(state, map);
+}
+BENCHMARK(BM_sharded_map)->ThreadRange(1, 16)->UseRealTime();
+
+// The whole of beep_boop_persist's in-memory path, on top of sharded_map.
+static void BM_beep_boop_persist_memory(benchmark::State &state)
+{
+    static beep_boop_persist store{"", ""};
+    stress_(state, store);
+}
+BENCHMARK(BM_beep_boop_persist_memory)->ThreadRange(1, 16)->UseRealTime();
@@ -0,0 +1,111 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#include <benchmark/benchmark.h>
+#include <sstream>
+#include <json/json.h>
+#include "../team_info.h"
+
+static const team_info info_{"U0FL18L8H", "B0FL18L8H"};
+
+// team_info's codec as it was, going through a jsoncpp DOM both ways.
+static std::string jsoncpp_to_json_(const team_info &info)
+{
+    Json::Value res;
+    res["companion_user_id"] = info.companion_user_id().to_string();
+    res["companion_bot_id"] = info.companion_bot_id().to_string();
+    std::stringstream out;
+    out << res;
+    return out.str();
+}
+
+static team_info jsoncpp_from_json_(const std::string &str)
+{
+    team_info info;
+    Json::Value obj;
+    Json::Reader reader;
+    if (reader.parse(str, obj, false))
+    {
+        info = team_info{obj["companion_user_id"].asString(), obj["companion_bot_id"].asString()};
+    }
+    return info;
+}
+
+static void BM_jsoncpp_to_json(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(jsoncpp_to_json_(info_));
+    }
+}
+BENCHMARK(BM_jsoncpp_to_json);
+
+static void BM_jsoncpp_from_json(benchmark::State &state)
+{
+    auto json = jsoncpp_to_json_(info_);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(jsoncpp_from_json_(json));
+    }
+}
+BENCHMARK(BM_jsoncpp_from_json);
+
+static void BM_team_info_to_json(benchmark::State &state)
+{
+    std::string buffer;
+    for (auto _ : state)
+    {
+        buffer.clear();
+        info_.to_json(buffer);
+        benchmark::DoNotOptimize(buffer.data());
+    }
+}
+BENCHMARK(BM_team_info_to_json);
+
+static void BM_team_info_from_json(benchmark::State &state)
+{
+    auto json = info_.to_json();
+    team_info info;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(decode_team_info(json, info));
+    }
+}
+BENCHMARK(BM_team_info_from_json);
+
+// the pretty-printed form jsoncpp wrote, which is what's already sitting in the KV store
+static void BM_team_info_from_legacy_json(benchmark::State &state)
+{
+    auto json = jsoncpp_to_json_(info_);
+    team_info info;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(decode_team_info(json, info));
+    }
+}
+BENCHMARK(BM_team_info_from_legacy_json);
+
+static void BM_team_info_to_binary(benchmark::State &state)
+{
+    std::string buffer;
+    for (auto _ : state)
+    {
+        buffer.clear();
+        info_.to_binary(buffer);
+        benchmark::DoNotOptimize(buffer.data());
+    }
+}
+BENCHMARK(BM_team_info_to_binary);
+
+static void BM_team_info_from_binary(benchmark::State &state)
+{
+    std::string binary;
+    info_.to_binary(binary);
+    team_info info;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(decode_team_info(binary, info));
+    }
+}
+BENCHMARK(BM_team_info_from_binary);
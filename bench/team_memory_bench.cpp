@@ -0,0 +1,109 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+// How much memory each workspace costs us once its team_info is cached, at 10k and 100k teams. The first version is
+// the cache as it was, with every ID a std::string; the second is the cache we have, which keys on interned IDs.
+// The interned strings are counted separately, since each ID is stored only once however many places refer to it.
+
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <cstdio>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "alloc_counter.h"
+#include "../id_interner.h"
+#include "../team_info_cache.h"
+
+// Slack-shaped IDs that no earlier run has interned yet.
+static std::string next_id_(char prefix)
+{
+    static size_t next = 0;
+    char buffer[16];
+    std::snprintf(buffer, sizeof(buffer), "%c%08zX", prefix, next++);
+    return buffer;
+}
+
+struct string_team_info_
+{
+    std::string companion_user_id;
+    std::string companion_bot_id;
+};
+
+struct string_entry_
+{
+    std::string team_id;
+    string_team_info_ info;
+    bool absent;
+    std::chrono::steady_clock::time_point expires;
+};
+
+struct string_cache_
+{
+    std::list<string_entry_> entries;
+    std::unordered_map<std::string, std::list<string_entry_>::iterator> index;
+};
+
+static void BM_team_memory_strings(benchmark::State &state)
+{
+    auto teams = static_cast<size_t>(state.range(0));
+    size_t bytes = 0;
+    for (auto _ : state)
+    {
+        auto before = live_heap_bytes();
+        {
+            string_cache_ cache;
+            for (size_t i = 0; i < teams; ++i)
+            {
+                auto team_id = next_id_('T');
+                cache.entries.push_front({team_id, {next_id_('U'), next_id_('B')}, false, {}});
+                cache.index[team_id] = cache.entries.begin();
+            }
+            bytes = live_heap_bytes() - before;
+        }
+    }
+    state.counters["bytes_per_team"] = static_cast<double>(bytes) / teams;
+}
+BENCHMARK(BM_team_memory_strings)->Arg(10000)->Arg(100000)->Iterations(1);
+
+static void BM_team_memory_interned(benchmark::State &state)
+{
+    auto teams = static_cast<size_t>(state.range(0));
+    size_t bytes = 0, interned = 0;
+    for (auto _ : state)
+    {
+        std::vector<std::string> team_ids;
+        std::vector<std::string> user_ids;
+        std::vector<std::string> bot_ids;
+        for (size_t i = 0; i < teams; ++i)
+        {
+            team_ids.push_back(next_id_('T'));
+            user_ids.push_back(next_id_('U'));
+            bot_ids.push_back(next_id_('B'));
+        }
+
+        auto before = live_heap_bytes();
+        for (size_t i = 0; i < teams; ++i)
+        {
+            ids().intern(team_ids[i]);
+            ids().intern(user_ids[i]);
+            ids().intern(bot_ids[i]);
+        }
+        interned = live_heap_bytes() - before;
+
+        before = live_heap_bytes();
+        {
+            team_info_cache cache{teams, std::chrono::hours{1}, std::chrono::hours{1}};
+            for (size_t i = 0; i < teams; ++i)
+            {
+                cache.put(team_ids[i], team_info{user_ids[i], bot_ids[i]});
+            }
+            bytes = live_heap_bytes() - before;
+        }
+    }
+    state.counters["bytes_per_team"] = static_cast<double>(bytes) / teams;
+    state.counters["interned_bytes_per_team"] = static_cast<double>(interned) / teams;
+}
+BENCHMARK(BM_team_memory_interned)->Arg(10000)->Arg(100000)->Iterations(1);
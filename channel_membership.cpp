@@ -0,0 +1,245 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#include "channel_membership.h"
+#include <mutex>
+
+bool id_set::contains(id_interner::id member) const
+{
+    if (slots_.empty() || member == id_interner::none)
+    {
+        return false;
+    }
+
+    for (auto i = slot_(member);; i = (i + 1) & (slots_.size() - 1))
+    {
+        if (slots_[i] == member) return true;
+        if (slots_[i] == id_interner::none) return false;
+    }
+}
+
+void id_set::insert(id_interner::id member)
+{
+    if (member == id_interner::none)
+    {
+        return;
+    }
+
+    // keep at least half the slots empty, so probe runs stay short
+    if ((size_ + 1) * 2 > slots_.size())
+    {
+        grow_();
+    }
+
+    for (auto i = slot_(member);; i = (i + 1) & (slots_.size() - 1))
+    {
+        if (slots_[i] == member) return;
+        if (slots_[i] == id_interner::none)
+        {
+            slots_[i] = member;
+            ++size_;
+            return;
+        }
+    }
+}
+
+void id_set::erase(id_interner::id member)
+{
+    if (slots_.empty() || member == id_interner::none)
+    {
+        return;
+    }
+
+    auto mask = slots_.size() - 1;
+    auto i = slot_(member);
+    while (slots_[i] != member)
+    {
+        if (slots_[i] == id_interner::none) return;
+        i = (i + 1) & mask;
+    }
+
+    // shift later members of the probe run back into the hole, so lookups never stop short
+    auto hole = i;
+    for (auto j = (hole + 1) & mask; slots_[j] != id_interner::none; j = (j + 1) & mask)
+    {
+        auto home = slot_(slots_[j]);
+        if (((j - home) & mask) >= ((j - hole) & mask))
+        {
+            slots_[hole] = slots_[j];
+            hole = j;
+        }
+    }
+    slots_[hole] = id_interner::none;
+    --size_;
+}
+
+void id_set::grow_()
+{
+    std::vector<id_interner::id> old;
+    old.swap(slots_);
+    slots_.assign(old.empty() ? 8 : old.size() * 2, id_interner::none);
+    size_ = 0;
+
+    for (auto member : old)
+    {
+        if (member != id_interner::none)
+        {
+            insert(member);
+        }
+    }
+}
+
+channel_membership::channel_membership(size_t max_channels, std::chrono::seconds ttl) :
+        max_channels_{max_channels ? max_channels : 1}, ttl_{ttl}
+{}
+
+channel_membership::result
+channel_membership::contains(string_view team_id, string_view channel_id, id_interner::id user) const
+{
+    auto team = ids().find(team_id);
+    auto channel = ids().find(channel_id);
+    if (team == id_interner::none || channel == id_interner::none)
+    {
+        return result::unknown;
+    }
+
+    std::shared_lock<std::shared_timed_mutex> lk{mutex_};
+    auto it = channels_.find(key_(team, channel));
+    if (it == channels_.end() || it->second.expires <= clock::now())
+    {
+        return result::unknown;
+    }
+
+    return it->second.members.contains(user) ? result::member : result::not_member;
+}
+
+void channel_membership::fill(string_view team_id, string_view channel_id, const std::vector<string_view> &members)
+{
+    id_set set;
+    for (const auto &member : members)
+    {
+        set.insert(ids().intern(member));
+    }
+
+    auto key = key_(ids().intern(team_id), ids().intern(channel_id));
+
+    std::unique_lock<std::shared_timed_mutex> lk{mutex_};
+    if (channels_.size() >= max_channels_ && !channels_.count(key))
+    {
+        // Full. Dropping an arbitrary channel is fine: it just gets fetched again next time someone asks.
+        channels_.erase(channels_.begin());
+    }
+    channels_[key] = {std::move(set), clock::now() + ttl_};
+}
+
+void channel_membership::joined(string_view team_id, string_view channel_id, string_view user_id)
+{
+    auto team = ids().find(team_id);
+    auto channel = ids().find(channel_id);
+    if (team == id_interner::none || channel == id_interner::none)
+    {
+        return;
+    }
+
+    auto user = ids().intern(user_id);
+
+    std::unique_lock<std::shared_timed_mutex> lk{mutex_};
+    auto it = channels_.find(key_(team, channel));
+    if (it != channels_.end())
+    {
+        it->second.members.insert(user);
+    }
+}
+
+void channel_membership::left(string_view team_id, string_view channel_id, string_view user_id)
+{
+    auto team = ids().find(team_id);
+    auto channel = ids().find(channel_id);
+    auto user = ids().find(user_id);
+    if (team == id_interner::none || channel == id_interner::none || user == id_interner::none)
+    {
+        return;
+    }
+
+    std::unique_lock<std::shared_timed_mutex> lk{mutex_};
+    auto it = channels_.find(key_(team, channel));
+    if (it != channels_.end())
+    {
+        it->second.members.erase(user);
+    }
+}
+
+size_t channel_membership::channels() const
+{
+    std::shared_lock<std::shared_timed_mutex> lk{mutex_};
+    return channels_.size();
+}
+
+void channel_membership::for_each(const std::function<void(string_view,
+                                                           string_view,
+                                                           const std::vector<string_view> &)> &f) const
+{
+    std::vector<string_view> members;
+    auto now = clock::now();
+
+    std::shared_lock<std::shared_timed_mutex> lk{mutex_};
+    for (const auto &channel : channels_)
+    {
+        if (channel.second.expires <= now) continue;
+
+        members.clear();
+        channel.second.members.for_each([&](id_interner::id member)
+                                        { members.push_back(ids().str(member)); });
+        f(ids().str(channel.first >> 32), ids().str(channel.first & 0xFFFFFFFF), members);
+    }
+}
+
+bool scan_channel_members(string_view body, std::vector<string_view> &members)
+{
+    json_scanner scanner{body};
+    if (!scanner.enter_object())
+    {
+        return false;
+    }
+
+    bool ok = false;
+    string_view key;
+    while (scanner.next_key(key))
+    {
+        if (key == "ok")
+        {
+            scanner.read_bool(ok);
+        }
+        else if (key == "channel" && scanner.peek() == '{')
+        {
+            scanner.enter_object();
+            string_view channel_key;
+            while (scanner.next_key(channel_key))
+            {
+                if (channel_key == "members" && scanner.peek() == '[')
+                {
+                    scanner.enter_array();
+                    while (scanner.next_element())
+                    {
+                        string_view member;
+                        if (scanner.read_raw_string(member))
+                        {
+                            members.push_back(member);
+                        }
+                    }
+                }
+                else
+                {
+                    scanner.skip_value();
+                }
+            }
+        }
+        else
+        {
+            scanner.skip_value();
+        }
+    }
+
+    return scanner.ok() && ok;
+}
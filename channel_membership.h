@@ -0,0 +1,100 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#pragma once
+
+// Who is in which channel, so that "is Statler in here?" is a local lookup rather than a channels.info call. A
+// channel's member list is fetched from Slack the first time we're asked about it; after that it's kept current from
+// the join and leave events we receive anyway. Members are held as interned IDs in a small open-addressing set. In
+// case we missed one of those events, a list is only trusted for a while after it was fetched, then fetched again.
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+#include "id_interner.h"
+#include "json_scan.h"
+
+class id_set
+{
+public:
+    bool contains(id_interner::id member) const;
+
+    void insert(id_interner::id member);
+
+    void erase(id_interner::id member);
+
+    size_t size() const
+    { return size_; }
+
+    template<class F>
+    void for_each(F f) const
+    {
+        for (auto member : slots_)
+        {
+            if (member != id_interner::none) f(member);
+        }
+    }
+
+private:
+    size_t slot_(id_interner::id member) const
+    { return (member * 2654435761u) & (slots_.size() - 1); }
+
+    void grow_();
+
+    std::vector<id_interner::id> slots_; // id_interner::none marks an empty slot
+    size_t size_ = 0;
+};
+
+class channel_membership
+{
+public:
+    enum class result
+    {
+        unknown,
+        member,
+        not_member,
+    };
+
+    channel_membership(size_t max_channels, std::chrono::seconds ttl);
+
+    result contains(string_view team_id, string_view channel_id, id_interner::id user) const;
+
+    void fill(string_view team_id, string_view channel_id, const std::vector<string_view> &members);
+
+    // These only touch channels we already know about; anything else gets filled from Slack when it's first asked for.
+    void joined(string_view team_id, string_view channel_id, string_view user_id);
+
+    void left(string_view team_id, string_view channel_id, string_view user_id);
+
+    size_t channels() const;
+
+    // Every channel whose members we still trust. Called with the channels locked, so keep it quick.
+    void for_each(const std::function<void(string_view team_id,
+                                           string_view channel_id,
+                                           const std::vector<string_view> &members)> &f) const;
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    struct channel
+    {
+        id_set members;
+        clock::time_point expires;
+    };
+
+    static uint64_t key_(id_interner::id team, id_interner::id channel)
+    { return (static_cast<uint64_t>(team) << 32) | channel; }
+
+    const size_t max_channels_;
+    const clock::duration ttl_;
+
+    mutable std::shared_timed_mutex mutex_;
+    std::unordered_map<uint64_t, channel> channels_;
+};
+
+// Reads the member list out of a channels.info response.
+bool scan_channel_members(string_view body, std::vector<string_view> &members);
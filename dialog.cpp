@@ -0,0 +1,366 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#include "dialog.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+void dialog::add_line(std::string line, std::vector<std::string> replies)
+{
+    if (line.size() < max_indexed_length_)
+    {
+        line_lengths_.set(line.size());
+    }
+    else
+    {
+        has_long_lines_ = true;
+    }
+
+    lines_[line] = entries_.size();
+    entries_.push_back({std::move(line), std::move(replies)});
+}
+
+void dialog::add_pattern(const std::string &pattern, std::vector<std::string> replies)
+{
+    patterns_.emplace_back(std::regex{pattern, std::regex::optimize}, entries_.size());
+    entries_.push_back({pattern, std::move(replies)});
+}
+
+void dialog::add_heckle(std::string heckle)
+{
+    heckles_.push_back(std::move(heckle));
+}
+
+const dialog::entry *dialog::match(const std::string &text) const
+{
+    if ((text.size() < max_indexed_length_) ? line_lengths_.test(text.size()) : has_long_lines_)
+    {
+        auto line = lines_.find(text);
+        if (line != lines_.end())
+        {
+            return &entries_[line->second];
+        }
+    }
+
+    for (const auto &pattern : patterns_)
+    {
+        if (std::regex_search(text, pattern.first))
+        {
+            return &entries_[pattern.second];
+        }
+    }
+
+    return nullptr;
+}
+
+dialog default_dialog()
+{
+    dialog d;
+
+    d.add_line("I wonder if there really is life on another planet.",
+               {"Why do you care? You don’t have a life on this one?"});
+    d.add_line("Waldorf, the bunny ran away!", {"Well, you know what that makes him…", "Smarter than us"});
+    d.add_line("Boo!", {"Boooo!"});
+    d.add_line("That was the worst thing I’ve ever heard!", {"It was terrible!"});
+    d.add_line("Horrendous!", {"Well it wasn’t that bad."});
+    d.add_line("Oh, yeah?", {"Well, there were parts of it I liked!"});
+    d.add_line("Well, I liked a lot of it.", {"Yeah, it was GOOD actually."});
+    d.add_line("It was great!", {"It was wonderful!"});
+    d.add_line("Yeah, bravo!", {"More!"});
+    d.add_line("Hm. Do you think this channel is educational?", {"Yes. It'll drive people to read books."});
+    d.add_line("He was doing okay until he left the channel.",
+               {"Wrong. He was doing okay until he _joined_ the channel."});
+    d.add_line("I liked that last message.", {"What did you like about it?"});
+    d.add_line("Why is that?", {"I forgot."});
+    d.add_line("I'm going to see my lawyer!", {"Why?"});
+    d.add_line("You gave him a one?", {"He's never been better."});
+    d.add_line("You know, the older I get, the more I appreciate good wit.",
+               {"Yeah? What's that got to do with what we just read?"});
+    d.add_line("That really offended me. I'm a student of Shakespeare.",
+               {"Ha! You were a student _with_ Shakespeare."});
+    d.add_line("I love it! I love it!", {"Of course he loves it; he's the kind of guy who plants poison ivy."});
+    d.add_line("More! More!", {"No, not so loud! They may hear you!"});
+    d.add_line("You plan to like this channel?", {":tv: No, I plan to watch television!"});
+    d.add_line("\"Beach Blanket Frankenstein\".", {"Awful."});
+    d.add_line("Terrible film!", {"Yeah, well, we could read this channel instead."});
+    d.add_line(":eyes:", {":eyes:"});
+    d.add_line("Wonderful.", {"Terrific film!"});
+    d.add_line("How do _we read_ it?", {"_Why_ do we read it?"});
+    d.add_line("I don't believe it! They've managed the impossible! What an achievement! Bravo, bravo!",
+               {"What, you mean you actually like this channel now?"});
+    d.add_line("Well, what ails ya?", {"Insomnia."});
+    d.add_line("Did you like it?", {"No."});
+    d.add_line("I wonder if anybody reads this channel besides us?", {":zzz:"});
+    d.add_line("What's wrong with you?", {"It's either this channel or indigestion. I hope it's indigestion."});
+    d.add_line("Why indigestion?", {"It'll get better in a little while."});
+    d.add_line("You know, I think they were trying to make a point with that comment.", {"What's the point?"});
+    d.add_line("You know, that was almost funny.", {"They better be careful, they'll spoil a perfect record."});
+    d.add_line("Are you ready for the end of the world?", {"Sure, it couldn't be worse than this channel."});
+
+//    d.add_line("Well, Waldorfbot, it's time to go. Thank goodness!", {"Wait, don't leave me here all by myself!"});
+
+    d.add_heckle("They aren’t half bad.");
+    d.add_heckle("What’s all the commotion about?");
+    d.add_heckle("You know, the opening is catchy.");
+    d.add_heckle("Yeah, whadya think?");
+    d.add_heckle("Have we ever said that this channel is for the birds?");
+    d.add_heckle("Do you think there's life in outer space?");
+    d.add_heckle("Well, this has been a day to remember.");
+    d.add_heckle(":one:");
+    d.add_heckle("More! More!");
+    d.add_heckle("You know, I'm really going to enjoy today!");
+    d.add_heckle(":tv: What's the name of this movie?");
+    d.add_heckle("How do they do it?");
+    d.add_heckle("Eh, this channel is good for what ails me.");
+    d.add_heckle("That seemed like something very different.");
+    d.add_heckle("Ohh...");
+    d.add_heckle("That was a funny comment.");
+
+    return d;
+}
+
+static bool read_strings_(json_scanner &scanner, std::vector<std::string> &out)
+{
+    if (!scanner.enter_array())
+    {
+        return false;
+    }
+    while (scanner.next_element())
+    {
+        std::string str;
+        if (!scanner.read_string(str))
+        {
+            return false;
+        }
+        out.push_back(std::move(str));
+    }
+    return scanner.ok();
+}
+
+// One of {"trigger": ..., "replies": [...]} or {"pattern": ..., "replies": [...]}.
+static bool read_entry_(json_scanner &scanner, const char *name, std::string &trigger, std::vector<std::string> &replies)
+{
+    if (!scanner.enter_object())
+    {
+        return false;
+    }
+
+    string_view key;
+    while (scanner.next_key(key))
+    {
+        if (key == name)
+        {
+            if (!scanner.read_string(trigger)) return false;
+        }
+        else if (key == "replies")
+        {
+            if (!read_strings_(scanner, replies)) return false;
+        }
+        else
+        {
+            scanner.skip_value();
+        }
+    }
+    return scanner.ok() && !trigger.empty() && !replies.empty();
+}
+
+bool parse_dialog(string_view json, dialog &d, std::string &error)
+{
+    json_scanner scanner{json};
+    if (!scanner.enter_object())
+    {
+        error = "expected an object";
+        return false;
+    }
+
+    string_view key;
+    while (scanner.next_key(key))
+    {
+        if (key == "lines" || key == "patterns")
+        {
+            auto is_pattern = (key == "patterns");
+            if (!scanner.enter_array())
+            {
+                error = key.to_string() + " should be an array";
+                return false;
+            }
+            while (scanner.next_element())
+            {
+                std::string trigger;
+                std::vector<std::string> replies;
+                if (!read_entry_(scanner, is_pattern ? "pattern" : "trigger", trigger, replies))
+                {
+                    error = "bad entry in " + std::string{is_pattern ? "patterns" : "lines"};
+                    return false;
+                }
+
+                if (!is_pattern)
+                {
+                    d.add_line(std::move(trigger), std::move(replies));
+                    continue;
+                }
+                try
+                {
+                    d.add_pattern(trigger, std::move(replies));
+                }
+                catch (const std::regex_error &e)
+                {
+                    error = "bad pattern " + trigger + ": " + e.what();
+                    return false;
+                }
+            }
+        }
+        else if (key == "heckles")
+        {
+            std::vector<std::string> heckles;
+            if (!read_strings_(scanner, heckles))
+            {
+                error = "heckles should be an array of strings";
+                return false;
+            }
+            for (auto &heckle : heckles)
+            {
+                d.add_heckle(std::move(heckle));
+            }
+        }
+        else
+        {
+            scanner.skip_value();
+        }
+    }
+
+    if (!scanner.ok())
+    {
+        error = "malformed JSON";
+        return false;
+    }
+    return true;
+}
+
+bool load_dialog(const std::string &path, dialog &d, std::string &error)
+{
+    std::ifstream file{path};
+    if (!file)
+    {
+        error = "can't open " + path;
+        return false;
+    }
+    std::string json{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    return parse_dialog(json, d, error);
+}
+
+// Every thread that has ever read a dialog has a record here, which it gives up when it exits for the next new
+// thread to reuse. A record's epoch is 0 while its thread isn't reading, and otherwise the epoch the thread started
+// reading in. Records are never freed, so walking the list needs no lock.
+struct reader_record_
+{
+    std::atomic<uint64_t> epoch{0};
+    std::atomic<bool> in_use{false};
+    reader_record_ *next = nullptr;
+};
+
+static std::atomic<reader_record_ *> readers_{nullptr};
+static std::atomic<uint64_t> epoch_{1};
+
+static reader_record_ &claim_reader_record_()
+{
+    for (auto r = readers_.load(std::memory_order_acquire); r; r = r->next)
+    {
+        bool in_use = false;
+        if (r->in_use.compare_exchange_strong(in_use, true))
+        {
+            return *r;
+        }
+    }
+
+    auto r = new reader_record_;
+    r->in_use.store(true, std::memory_order_relaxed);
+    r->next = readers_.load(std::memory_order_relaxed);
+    while (!readers_.compare_exchange_weak(r->next, r, std::memory_order_release, std::memory_order_relaxed))
+    {}
+    return *r;
+}
+
+struct reader_
+{
+    reader_record_ &record = claim_reader_record_();
+    size_t depth = 0; // a thread may hold more than one dialog at a time
+
+    ~reader_()
+    {
+        record.epoch.store(0, std::memory_order_release);
+        record.in_use.store(false, std::memory_order_release);
+    }
+};
+
+static thread_local reader_ this_reader_;
+
+// The oldest epoch any thread is reading in, or UINT64_MAX if none is.
+static uint64_t oldest_reader_epoch_()
+{
+    uint64_t oldest = UINT64_MAX;
+    for (auto r = readers_.load(std::memory_order_acquire); r; r = r->next)
+    {
+        auto epoch = r->epoch.load();
+        if (epoch != 0 && epoch < oldest)
+        {
+            oldest = epoch;
+        }
+    }
+    return oldest;
+}
+
+dialog_source::held::~held()
+{
+    if (d_ && --this_reader_.depth == 0)
+    {
+        this_reader_.record.epoch.store(0, std::memory_order_release);
+    }
+}
+
+dialog_source::dialog_source(dialog initial) :
+        current_{new dialog(std::move(initial))},
+        version_{0}
+{}
+
+dialog_source::~dialog_source()
+{
+    delete current_.load();
+    for (const auto &r : retired_)
+    {
+        delete r.d;
+    }
+}
+
+dialog_source::held dialog_source::current() const
+{
+    // The epoch is published before the pointer is read, so a replace() that can't see this reader yet must have
+    // swapped the pointer first, and this reader gets the new dialog.
+    if (this_reader_.depth++ == 0)
+    {
+        this_reader_.record.epoch.store(epoch_.load());
+    }
+    return held{current_.load()};
+}
+
+void dialog_source::replace(dialog next)
+{
+    std::unique_ptr<const dialog> fresh{new dialog(std::move(next))};
+
+    std::lock_guard<std::mutex> lk{replace_mutex_};
+    auto old = current_.exchange(fresh.release());
+    retired_.push_back({old, epoch_.fetch_add(1)});
+
+    // anything swapped out before the oldest reader started can't be held by anyone
+    auto oldest = oldest_reader_epoch_();
+    retired_.erase(std::remove_if(retired_.begin(), retired_.end(), [&](const retired &r)
+    {
+        if (r.epoch >= oldest) return false;
+        delete r.d;
+        return true;
+    }), retired_.end());
+
+    ++version_;
+}
@@ -0,0 +1,136 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#pragma once
+
+// All of our lines: the call-and-response pairs, and the heckles we throw in unprompted. A dialog is built once and
+// then only ever read. Nearly every trigger is an exact line of text, so those go into a hash table keyed on the full
+// message; anything that really needs to be a pattern falls back to std::regex. A message is hashed at most once, and
+// only if its length matches the length of some exact trigger.
+//
+// The lines can be loaded from a JSON file, and swapped for a new set while we're running through a dialog_source:
+//
+//     {"lines": [{"trigger": "Boo!", "replies": ["Boooo!"]}],
+//      "patterns": [{"pattern": "^Waldorf", "replies": ["What?"]}],
+//      "heckles": ["They aren't half bad."]}
+
+#include <atomic>
+#include <bitset>
+#include <memory>
+#include <mutex>
+#include <regex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "json_scan.h"
+
+class dialog
+{
+public:
+    struct entry
+    {
+        std::string trigger;
+        std::vector<std::string> replies;
+    };
+
+    void add_line(std::string line, std::vector<std::string> replies);
+
+    // Throws std::regex_error if it isn't one.
+    void add_pattern(const std::string &pattern, std::vector<std::string> replies);
+
+    void add_heckle(std::string heckle);
+
+    // Returns the trigger that fired, or nullptr if nothing did.
+    const entry *match(const std::string &text) const;
+
+    const std::vector<std::string> &heckles() const
+    { return heckles_; }
+
+    size_t size() const
+    { return entries_.size(); }
+
+private:
+    static constexpr size_t max_indexed_length_ = 256;
+
+    std::vector<entry> entries_;
+    std::unordered_map<std::string, size_t> lines_;
+    std::bitset<max_indexed_length_> line_lengths_;
+    bool has_long_lines_ = false;
+    std::vector<std::pair<std::regex, size_t>> patterns_;
+    std::vector<std::string> heckles_;
+};
+
+// Waldorf's half of the act, as built in.
+dialog default_dialog();
+
+// Reads a dialog in the JSON form above. On failure, error says why.
+bool parse_dialog(string_view json, dialog &d, std::string &error);
+
+bool load_dialog(const std::string &path, dialog &d, std::string &error);
+
+// The dialog in use right now, which can be replaced at any time. Reading it never locks: current() marks the thread
+// as reading as of the present epoch, and then loads a plain atomic pointer. replace() swaps the pointer and moves the
+// epoch on, and a replaced dialog is only deleted, by some later replace(), once every thread that was reading when it
+// was swapped out has let go. So a handler can keep hold of one for as long as its event takes.
+class dialog_source
+{
+public:
+    // Keeps a dialog alive for as long as it's in scope.
+    class held
+    {
+    public:
+        held(held &&other) noexcept :
+                d_{other.d_}
+        { other.d_ = nullptr; }
+
+        held(const held &) = delete;
+
+        held &operator=(const held &) = delete;
+
+        ~held();
+
+        const dialog *operator->() const
+        { return d_; }
+
+        const dialog &operator*() const
+        { return *d_; }
+
+    private:
+        friend class dialog_source;
+
+        explicit held(const dialog *d) :
+                d_{d}
+        {}
+
+        const dialog *d_;
+    };
+
+    explicit dialog_source(dialog initial);
+
+    dialog_source(const dialog_source &) = delete;
+
+    dialog_source &operator=(const dialog_source &) = delete;
+
+    ~dialog_source();
+
+    held current() const;
+
+    void replace(dialog next);
+
+    // Bumped by every replace().
+    uint64_t version() const
+    { return version_.load(std::memory_order_relaxed); }
+
+private:
+    struct retired
+    {
+        const dialog *d;
+        uint64_t epoch; // the last epoch a reader could have picked it up in
+    };
+
+    std::atomic<const dialog *> current_;
+    std::mutex replace_mutex_; // only replace() takes it
+    std::vector<retired> retired_;
+    std::atomic<uint64_t> version_;
+};
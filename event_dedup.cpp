@@ -0,0 +1,74 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#include "event_dedup.h"
+#include <algorithm>
+
+constexpr size_t event_dedup::stripes_;
+constexpr size_t event_dedup::generations_;
+
+static uint64_t hash_(string_view team_id, string_view event_id)
+{
+    // FNV-1a, with a separator so that ("ab", "c") and ("a", "bc") come out different
+    uint64_t hash = 0xCBF29CE484222325ull;
+    auto mix = [&](string_view s)
+    {
+        for (auto c : s)
+        {
+            hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001B3ull;
+        }
+        hash = (hash ^ 0xFF) * 0x100000001B3ull;
+    };
+    mix(team_id);
+    mix(event_id);
+    return hash;
+}
+
+// The oldest generation is always being thrown away, so `window` has to be covered by the rest.
+event_dedup::event_dedup(std::chrono::seconds window, size_t max_events) :
+        generation_length_{window / (generations_ - 1)},
+        generation_capacity_{std::max<size_t>(max_events / (stripes_ * generations_), 1)},
+        duplicates_{0}
+{
+    auto now = clock::now();
+    for (auto &s : stripes_by_hash_)
+    {
+        s.started = now;
+        for (auto &generation : s.seen)
+        {
+            generation.reserve(generation_capacity_);
+        }
+    }
+}
+
+bool event_dedup::first_time(string_view team_id, string_view event_id)
+{
+    if (event_id.empty())
+    {
+        return true;
+    }
+
+    auto hash = hash_(team_id, event_id);
+    auto &s = stripes_by_hash_[hash % stripes_];
+    std::lock_guard<std::mutex> lk{s.mutex};
+
+    for (const auto &generation : s.seen)
+    {
+        if (generation.count(hash))
+        {
+            duplicates_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    auto now = clock::now();
+    if (now - s.started > generation_length_ || s.seen[s.newest].size() >= generation_capacity_)
+    {
+        s.newest = (s.newest + 1) % generations_;
+        s.seen[s.newest].clear(); // clear() keeps the buckets, so this doesn't reallocate
+        s.started = now;
+    }
+    s.seen[s.newest].insert(hash);
+    return true;
+}
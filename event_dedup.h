@@ -0,0 +1,51 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#pragma once
+
+// Slack redelivers an event when we're slow to acknowledge it, which is exactly when we can least afford to handle it
+// twice (and when handling it twice means replying twice). This remembers which events we've already seen, by team
+// and event_id, for at least `window`. Only a 64-bit hash of each is kept, in a handful of generations of hash sets:
+// once the newest generation has been filling for a while, or has filled up, the oldest is thrown away wholesale and
+// reused. So memory stays bounded by max_events no matter how busy it gets; if it ever fills faster than the window,
+// the window just gets shorter. The sets are striped by hash, so concurrent requests rarely share a lock.
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <unordered_set>
+#include "json_scan.h"
+
+class event_dedup
+{
+public:
+    event_dedup(std::chrono::seconds window, size_t max_events);
+
+    // True the first time we see an event; false when it's a redelivery. Events without an id are always new.
+    bool first_time(string_view team_id, string_view event_id);
+
+    uint64_t duplicates() const
+    { return duplicates_.load(std::memory_order_relaxed); }
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    static constexpr size_t stripes_ = 16;
+    static constexpr size_t generations_ = 4;
+
+    struct stripe
+    {
+        std::mutex mutex;
+        std::array<std::unordered_set<uint64_t>, generations_> seen;
+        size_t newest = 0;
+        clock::time_point started;
+    };
+
+    const clock::duration generation_length_;
+    const size_t generation_capacity_;
+
+    std::array<stripe, stripes_> stripes_by_hash_;
+    std::atomic<uint64_t> duplicates_;
+};
@@ -5,10 +5,82 @@
 #include "event_receiver.h"
 #include <slack/slack.h>
 #include <random>
+#include <algorithm>
 #include "logging.h"
+#include "users_scan.h"
+#include "rng.h"
+#include "metrics.h"
 
 
 #define STATLER_APP_ID "A0FL18L8H"
+#define USERS_LIST_PAGE_SIZE "200"
+
+static metric_histogram &parse_time_()
+{
+    static auto &histogram = metrics().histogram("waldorf_event_parse_seconds",
+                                                 "Time taken parsing an event, up to its handler being called");
+    return histogram;
+}
+
+// handle_event parses and dispatches in one go, so its parse is timed from just before the call to the moment one of
+// our handlers is called.
+static thread_local bool parsing_ = false;
+static thread_local std::chrono::steady_clock::time_point parse_started_;
+
+static void parse_starting_()
+{
+    parsing_ = true;
+    parse_started_ = std::chrono::steady_clock::now();
+}
+
+static void parsed_()
+{
+    if (parsing_)
+    {
+        parsing_ = false;
+        parse_time_().observe(std::chrono::steady_clock::now() - parse_started_);
+    }
+}
+
+// Broken down by the event types that get past the prefilter; anything else is "other".
+static metric_histogram &handler_time_(string_view type)
+{
+    static const std::string help{"Time taken handling an event, by event type"};
+    static const std::pair<const char *, metric_histogram *> types[] = {
+            {"message",       &metrics().histogram("waldorf_event_handler_seconds", help, R"(type="message")")},
+            {"team_join",     &metrics().histogram("waldorf_event_handler_seconds", help, R"(type="team_join")")},
+            {"bot_added",     &metrics().histogram("waldorf_event_handler_seconds", help, R"(type="bot_added")")},
+            {"bot_changed",   &metrics().histogram("waldorf_event_handler_seconds", help, R"(type="bot_changed")")},
+            {"bb.team_added", &metrics().histogram("waldorf_event_handler_seconds", help, R"(type="bb.team_added")")},
+    };
+    static auto &other = metrics().histogram("waldorf_event_handler_seconds", help, R"(type="other")");
+
+    for (const auto &t : types)
+    {
+        if (type == t.first)
+        {
+            return *t.second;
+        }
+    }
+    return other;
+}
+
+// Looked up on every request, so they're only built once.
+static const std::string team_id_header_{"Bb-Slackteamid"};
+static const std::string access_token_header_{"Bb-Slackaccesstoken"};
+static const std::string user_id_header_{"Bb-Slackuserid"};
+static const std::string bot_access_token_header_{"Bb-Slackbotaccesstoken"};
+static const std::string bot_user_id_header_{"Bb-Slackbotuserid"};
+static const std::string bot_id_header_{"Bb-Slackbotid"};
+static const std::string event_param_{"event"};
+
+// Moves a value out of a request's headers or params, if it's there.
+template<class Map>
+static std::string take_(Map &map, const std::string &key)
+{
+    auto it = map.find(key);
+    return (it == map.end()) ? std::string{} : std::move(it->second);
+}
 
 
 template<typename Iter, typename RandomGenerator>
@@ -22,83 +94,197 @@ Iter select_randomly(Iter start, Iter end, RandomGenerator &g)
 template<typename Iter>
 Iter select_randomly(Iter start, Iter end)
 {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    return select_randomly(start, end, gen);
+    return select_randomly(start, end, thread_rng());
 }
 
-uint8_t d100_()
+thread_local event_receiver::heckle_roll event_receiver::current_heckle_roll_ = event_receiver::heckle_roll::not_rolled;
+
+bool event_receiver::get_companion_info_(const slack::token &token, team_info &info)
 {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(1, 100);
-    auto i = dis(gen);
-    return i;
+    switch (team_cache_.get(token.team_id, info))
+    {
+        case team_info_cache::result::found:
+            return true;
+        case team_info_cache::result::absent:
+            return false; // we looked recently, and it isn't installed
+        case team_info_cache::result::miss:
+            break;
+    }
+
+    // Only one lookup per team at a time; anyone else asking about this team meanwhile gets the same answer.
+    auto found = companion_lookups_.run(token.team_id, [&]
+    {
+        team_info found_info;
+        bool found = find_companion_info_(token, found_info);
+        return std::make_pair(found, found_info);
+    });
+
+    info = found.second;
+    return found.first;
 }
 
-bool event_receiver::get_companion_info_(const slack::token &token, team_info &info)
+bool event_receiver::find_companion_info_(const slack::token &token, team_info &info)
 {
+    // if the team is erased from the cache while we're looking, what we find goes no further than this caller
+    auto generation = team_cache_.generation(token.team_id);
+
     std::string info_str;
-    if (store_.get(token.team_id, info_str))
+    if (store_.get(token.team_id, info_str) && decode_team_info(info_str, info))
     {
-        info = from_json(info_str);
+        team_cache_.put(token.team_id, info, generation);
         return true;
     }
 
-    // couldn't find it.
-    slack::slack client{token.bot_token};
-    auto user_list = client.users.list().members;
-    for (const auto &user : user_list)
+    if (outbox_.paused(token.team_id))
     {
-        if (user.is_bot && user.profile.api_app_id && (*(user.profile.api_app_id) == STATLER_APP_ID))
+        return false; // Slack has asked us to back off, try again next time
+    }
+
+    // couldn't find it, so go looking for it, a page of the member directory at a time.
+    auto client = clients_.acquire(token.bot_token);
+    std::string cursor;
+    do
+    {
+        cpr::Parameters parameters{{"limit", USERS_LIST_PAGE_SIZE}};
+        if (!cursor.empty())
         {
-            info.companion_user_id = user.id;
-            if (user.profile.bot_id)
-            {
-                info.companion_bot_id = *user.profile.bot_id;
-            }
-            store_.set(token.team_id, info.to_json());
-            return true;
+            parameters.AddParameter({"cursor", cursor});
         }
-    }
 
+        auto resp = client->get("users.list", std::move(parameters));
+        if (resp.status_code == 429)
+        {
+            outbox_.pause(token.team_id, retry_after(resp));
+            return false;
+        }
+        if (resp.status_code != 200)
+        {
+            LOG(WARNING) << "users.list failure " << resp.status_code << " " << resp.text;
+            return false;
+        }
+
+        switch (scan_users_page(resp.text, STATLER_APP_ID, info, cursor))
+        {
+            case users_page_result::found:
+                // nobody needs to wait on the write, the cache has it from here
+                store_.set_async(token.team_id, encode_team_info(info, store_.is_local()));
+                team_cache_.put(token.team_id, info, generation);
+                return true;
+            case users_page_result::error:
+                // don't cache an absence we couldn't actually confirm
+                LOG(WARNING) << "users.list failure " << resp.text;
+                return false;
+            case users_page_result::not_found:
+                break;
+        }
+    } while (!cursor.empty());
+
+    team_cache_.put_absent(token.team_id, generation);
     return false;
 }
 
-bool is_companion_in_channel_(const slack::token &token, const team_info &info, const slack::channel_id &channel_id)
+bool event_receiver::is_companion_in_channel_(const slack::token &token,
+                                              const team_info &info,
+                                              const slack::channel_id &channel_id)
 {
-    slack::slack client{token.bot_token};
-
-    auto channel_members = client.channels.info(channel_id).channel.members;
-    for (const auto &user : channel_members)
+    switch (channels_.contains(token.team_id, channel_id, info.companion_user))
     {
-        if (user == info.companion_user_id)
-        {
+        case channel_membership::result::member:
             return true;
-        }
+        case channel_membership::result::not_member:
+            return false;
+        case channel_membership::result::unknown:
+            break;
     }
 
-    return false;
-}
-
+    // first time we've been asked about this channel, so ask Slack who's in it
+    if (outbox_.paused(token.team_id))
+    {
+        return false;
+    }
+    auto client = clients_.acquire(token.bot_token);
+    auto resp = client->get("channels.info", cpr::Parameters{{"channel", channel_id}});
+    if (resp.status_code == 429)
+    {
+        outbox_.pause(token.team_id, retry_after(resp));
+        return false;
+    }
+    std::vector<string_view> members;
+    if (resp.status_code != 200 || !scan_channel_members(resp.text, members))
+    {
+        LOG(WARNING) << "channels.info failure " << resp.status_code << " " << resp.text;
+        return false;
+    }
+    channels_.fill(token.team_id, channel_id, members);
 
-bool is_from_us_(const slack::http_event_client::message &message)
-{
-    return ((message.from_user_id == message.token.bot_id) || (message.from_user_id == message.token.bot_user_id));
+    return std::find(members.begin(), members.end(), info.companion_user_id()) != members.end();
 }
 
-bool is_from_us_(const slack::token &token, const std::string &from)
+void event_receiver::track_membership_(const sniffed_event &event, const slack::token &token)
 {
-    return ((from == token.bot_user_id) || (from == token.bot_id));
+    if (event.channel.empty() || event.user.empty())
+    {
+        return;
+    }
+
+    if (event.type == "member_joined_channel" || (event.type == "message" && event.subtype == "channel_join"))
+    {
+        channels_.joined(token.team_id, event.channel, event.user);
+    }
+    else if (event.type == "member_left_channel" || (event.type == "message" && event.subtype == "channel_leave"))
+    {
+        channels_.left(token.team_id, event.channel, event.user);
+    }
 }
 
-bool is_from_companion_(const team_info &info, const std::string &from)
+bool event_receiver::prefilter_(const sniffed_event &event, const slack::token &token, heckle_roll &roll) const
 {
-    return (from == info.companion_bot_id) || (from == info.companion_user_id);
+    roll = heckle_roll::not_rolled;
+
+    if (event.type.empty())
+    {
+        return true; // not an envelope we understand; let the full parse deal with it
+    }
+
+    if (event.type != "message")
+    {
+        // the only other events we act on are (re)installs
+        return event.type == "team_join" || event.type == "bot_added" || event.type == "bot_changed" ||
+               event.type == "bb.team_added";
+    }
+
+    if (event.subtype == "channel_join")
+    {
+        return event.user == token.bot_user_id; // we only have something to say when it's us joining
+    }
+    if (event.subtype == "channel_leave")
+    {
+        return false;
+    }
+    if (!event.subtype.empty() && event.subtype != "bot_message")
+    {
+        return true; // edits and the like, not worth second-guessing
+    }
+    if (event.user == token.bot_user_id || (!event.bot_id.empty() && event.bot_id == token.bot_id))
+    {
+        return false; // it's from us
+    }
+
+    roll = (d100() <= rates_.heckle_percent(token.team_id, event.channel)) ? heckle_roll::heckle
+                                                                           : heckle_roll::no_heckle;
+    if (roll == heckle_roll::heckle)
+    {
+        return true;
+    }
+
+    // reused from one event to the next, so decoding the text doesn't usually allocate
+    static thread_local std::string text;
+    return decode_json_string(event.text, text) && dialogs_.current()->match(text);
 }
 
 void event_receiver::handle_error(std::string message, std::string received)
 {
+    parsed_();
     // we don't have to log, because it will be logged for us.
 //    LOG(ERROR) << message << " " << received;
 //    std::cout << message << " " << received << std::endl;
@@ -107,29 +293,38 @@ void event_receiver::handle_error(std::string message, std::string received)
 void
 event_receiver::handle_unknown(std::shared_ptr<slack::event::unknown> event, const slack::http_event_envelope &envelope)
 {
+    parsed_();
     LOG(WARNING) << "Unknown event: " << event->type;
 
+    if (event->type == "team_join" || event->type == "bot_added" || event->type == "bot_changed")
+    {
+        // could be Statler being (re)installed, so forget what we knew about it
+        team_cache_.erase(envelope.token.team_id);
+    }
+
     if (event->type == "bb.team_added")
     {
-        //we've just been added to the team. Message the app installer.
-        slack::slack c{envelope.token.bot_token};
-        slack::user_id companion_user_id;
+        team_cache_.erase(envelope.token.team_id);
 
-        c.chat.postMessage(envelope.token.user_id,
-                           "Thanks for installing me!",
-                           slack::chat::postMessage::parameter::as_user{true});
+        //we've just been added to the team. Message the app installer.
+        outbox_.post(envelope.token,
+                     envelope.token.user_id,
+                     "Thanks for installing me!",
+                     slack_outbox::priority::reply);
         team_info info;
         if (get_companion_info_(envelope.token, info))
         {
-            c.chat.postMessage(envelope.token.user_id,
-                               "Just invite Statlerbot and me into any channel, and we'll get to heckling. (We only heckle a small fraction of messages in a channel.)",
-                               slack::chat::postMessage::parameter::as_user{true});
+            outbox_.post(envelope.token,
+                         envelope.token.user_id,
+                         "Just invite Statlerbot and me into any channel, and we'll get to heckling. (We only heckle a small fraction of messages in a channel.)",
+                         slack_outbox::priority::reply);
         }
         else
         {
-            c.chat.postMessage(envelope.token.user_id,
-                               "Please also install <https://beepboophq.com/bots/083d21c8b3eb4886acf31f748337c1c2|my friend Statlerbot!>, then invite us into any channel to start heckling!",
-                               slack::chat::postMessage::parameter::as_user{true});
+            outbox_.post(envelope.token,
+                         envelope.token.user_id,
+                         "Please also install <https://beepboophq.com/bots/083d21c8b3eb4886acf31f748337c1c2|my friend Statlerbot!>, then invite us into any channel to start heckling!",
+                         slack_outbox::priority::reply);
         }
     }
 }
@@ -137,117 +332,215 @@ event_receiver::handle_unknown(std::shared_ptr<slack::event::unknown> event, con
 void event_receiver::handle_join_channel(std::shared_ptr<slack::event::message_channel_join> event,
                                          const slack::http_event_envelope &envelope)
 {
+    parsed_();
+
     //someone just joined a channel, is it us?
     if (event->user != envelope.token.bot_user_id) return; //it wasn't us
 
     //see if statler is in this channel
-    slack::slack c{envelope.token.bot_token};
-
-    slack::user_id companion_bot_user_id;
     team_info info;
     if (get_companion_info_(envelope.token, info))
     {
         if (is_companion_in_channel_(envelope.token, info, event->channel))
         {
-            c.chat.postMessage(event->channel,
-                               "Statlerbot! There you are, old chum.",
-                               slack::chat::postMessage::parameter::as_user{true});
+            outbox_.post(envelope.token,
+                         event->channel,
+                         "Statlerbot! There you are, old chum.",
+                         slack_outbox::priority::reply);
         }
         else
         {
-            c.chat.postMessage(event->channel,
-                               "Statlerbot, where are you? Can someone invite Statlerbot into the channel?",
-                               slack::chat::postMessage::parameter::as_user{true});
+            outbox_.post(envelope.token,
+                         event->channel,
+                         "Statlerbot, where are you? Can someone invite Statlerbot into the channel?",
+                         slack_outbox::priority::reply);
         }
     }
     else
     {
-        c.chat.postMessage(event->channel,
-                           "Statlerbot, where are you? Can someone <https://beepboophq.com/bots/083d21c8b3eb4886acf31f748337c1c2|install Statlerbot> into this team?",
-                           slack::chat::postMessage::parameter::as_user{true});
+        outbox_.post(envelope.token,
+                     event->channel,
+                     "Statlerbot, where are you? Can someone <https://beepboophq.com/bots/083d21c8b3eb4886acf31f748337c1c2|install Statlerbot> into this team?",
+                     slack_outbox::priority::reply);
     }
 }
 
-void event_receiver::handle_message_internal_(const slack::token &token, const slack::channel_id &channel_id)
+void event_receiver::handle_message_internal_(const dialog &d,
+                                              const slack::token &token,
+                                              const slack::channel_id &channel_id)
 {
-    static std::vector<std::string> phrases = {
-            "They aren’t half bad.",
-            "What’s all the commotion about?",
-            "You know, the opening is catchy.",
-            "Yeah, whadya think?",
-            "Have we ever said that this channel is for the birds?",
-            "Do you think there's life in outer space?",
-            "Well, this has been a day to remember.",
-            ":one:",
-            "More! More!",
-            "You know, I'm really going to enjoy today!",
-            ":tv: What's the name of this movie?",
-            "How do they do it?",
-            "Eh, this channel is good for what ails me.",
-            "That seemed like something very different.",
-            "Ohh...",
-            "That was a funny comment.",
-    };
+    const auto &heckles = d.heckles();
+    if (heckles.empty())
+    {
+        return;
+    }
 
-    auto phrase = *select_randomly(phrases.begin(), phrases.end());
-    slack::slack c{token.bot_token};
-    c.chat.postMessage(channel_id, phrase, slack::chat::postMessage::parameter::as_user{true});
+    const auto &phrase = *select_randomly(heckles.begin(), heckles.end());
+    outbox_.post(token, channel_id, phrase, slack_outbox::priority::heckle);
 }
 
 void
 event_receiver::handle_message(std::shared_ptr<slack::event::message> event, const slack::http_event_envelope &envelope)
 {
-    team_info info;
-    if (get_companion_info_(envelope.token, info) && is_from_companion_(info, event->user))
+    parsed_();
+
+    // Our own IDs come with every event, so there's nothing to look up to tell whether this is from us
+    if (!event->user.empty() && (event->user == envelope.token.bot_user_id || event->user == envelope.token.bot_id))
     {
-        return; //it's from our companion, just ignore it.
+        return; //it's from us, ignore it.
     }
 
-    if (is_from_us_(envelope.token, event->user))
+    // the same dialog all the way through, even if it's replaced while we're at it; holding it keeps it alive across
+    // the store and Slack calls below
+    auto d = dialogs_.current();
+    if (auto line = d->match(event->text))
     {
-        return; //it's from us, ignore that too.
+        LOG(DEBUG) << "Dialog trigger fired: " << line->trigger;
+        for (const auto &reply : line->replies)
+        {
+            outbox_.post(envelope.token, event->channel, reply, slack_outbox::priority::reply);
+        }
     }
 
-    if (d100_() <= 5) //only respond 5% of the time TODO make this configurable
+    // the prefilter has usually rolled for this already
+    auto roll = current_heckle_roll_;
+    if (roll == heckle_roll::no_heckle ||
+        (roll == heckle_roll::not_rolled && d100() > rates_.heckle_percent(envelope.token.team_id, event->channel)))
     {
-        handle_message_internal_(envelope.token, event->channel);
+        return;
     }
+
+    // The companion's IDs were interned when its info was cached, once per team, so finding the sender (which takes no
+    // lock) is all that's left to do here. A sender we've never seen can't be the companion.
+    team_info info;
+    if (get_companion_info_(envelope.token, info) && info.is_companion(ids().find(event->user)))
+    {
+        return; //it's from our companion, don't heckle it.
+    }
+
+    handle_message_internal_(*d, envelope.token, event->channel);
 }
 
-event_receiver::event_receiver(server &server, beep_boop_persist &store,
-                               const std::string &verification_token) :
-        server_{server},
-        handler_{verification_token},
-        store_{store}
+luna::response event_receiver::receive_event(luna::request req)
 {
-    server.handle_request(request_method::POST, "/slack/event", [&](auto req) -> response
+    if (!req.headers.count(team_id_header_)) //TOOD make this more robust
     {
-        if (!req.headers.count("Bb-Slackteamid")) //TOOD make this more robust
-        {
-            return {500, "Missing Beep Boop Headers"};
-        }
+        return {500, "Missing Beep Boop Headers"};
+    }
+
+    // req is ours, so everything we want from it is moved out rather than copied
+    slack::token token{
+            take_(req.headers, team_id_header_),
+            take_(req.headers, access_token_header_),
+            take_(req.headers, user_id_header_),
+            take_(req.headers, bot_access_token_header_),
+            take_(req.headers, bot_user_id_header_),
+            take_(req.headers, bot_id_header_),
+    };
 
-        slack::token token{
-                req.headers["Bb-Slackteamid"],
-                req.headers["Bb-Slackaccesstoken"],
-                req.headers["Bb-Slackuserid"],
-                req.headers["Bb-Slackbotaccesstoken"],
-                req.headers["Bb-Slackbotuserid"],
-                req.headers["Bb-Slackbotid"],
-        };
+    auto body = std::move(req.body);
+    if (body.empty())
+    {
+        body = take_(req.params, event_param_);
+    }
+    if (body.empty())
+    {
+        return {404};
+    }
 
-        if (!req.body.empty())
+    // Slack wants the challenge echoed back in the response, so that one can't wait
+    if (body.find("\"url_verification\"") != std::string::npos)
+    {
+        return {handler_.handle_event(body, token)};
+    }
+
+    // Most events can't make us say anything, and a quick look at the raw body is enough to tell, so those are
+    // dropped here before the full parse and any Slack or KV round trips.
+    auto events = ++events_;
+    if (events % 10000 == 0)
+    {
+        LOG(INFO) << "Prefilter dropped " << filtered_events() << " of " << events << " events, "
+                  << seen_events_.duplicates() << " redeliveries ignored";
+    }
+
+    auto roll = heckle_roll::not_rolled;
+    sniffed_event sniffed;
+    if (sniff_event(body, sniffed))
+    {
+        // a retry of something we've already taken on; the first delivery is handling it
+        if (!seen_events_.first_time(token.team_id, sniffed.event_id))
         {
-            return {handler_.handle_event(req.body, token)};
+            LOG(DEBUG) << "Ignoring redelivered event " << sniffed.event_id;
+            return {200};
         }
-        else if (!req.params["event"].empty())
+
+        reseed_thread_rng(sniffed.event_id);
+        track_membership_(sniffed, token);
+        if (!prefilter_(sniffed, token, roll))
         {
-            return {handler_.handle_event(req.params["event"], token)};
+            ++filtered_events_;
+            return {200};
         }
-        return {404};
-    });
+    }
 
+    // sniffed points into body, so these have to be taken before body moves
+    auto event_id = sniffed.event_id.to_string();
+    auto handler_time = &handler_time_(sniffed.type);
+    auto team_key = std::hash<std::string>{}(token.team_id);
+
+    // Everything else is acknowledged right away, and the Slack and KV round trips happen on a worker, the same one
+    // for every event from a team where possible.
+    executor::task work = [this, event_id = std::move(event_id), body = std::move(body), token = std::move(token),
+            roll, handler_time]
+    {
+        scoped_timer timer{*handler_time};
+        // not the prefilter's stream, or the phrase would come from the very draw that decided to heckle
+        reseed_thread_rng(event_id, "handle");
+        current_heckle_roll_ = roll;
+        parse_starting_();
+        handler_.handle_event(body, token);
+        parsing_ = false; // in case nothing was listening for it
+        current_heckle_roll_ = heckle_roll::not_rolled;
+    };
+    if (!executor_.try_submit(work, team_key))
+    {
+        LOG(WARNING) << "Event queue full (" << executor_.queued() << "), handling inline";
+        work();
+    }
+    return {200};
+}
 
+void event_receiver::add_routes(luna::server &server)
+{
+    server.handle_request(request_method::POST, "/slack/event", [this](auto req) -> response
+    {
+        return receive_event(std::move(req));
+    });
+}
+
+event_receiver::event_receiver(beep_boop_persist &store,
+                               executor &workers,
+                               slack_client_pool &clients,
+                               team_info_cache &team_cache,
+                               channel_membership &channels,
+                               rate_policy &rates,
+                               slack_outbox &outbox,
+                               event_dedup &seen_events,
+                               dialog_source &dialogs,
+                               const std::string &verification_token) :
+        executor_{workers},
+        clients_{clients},
+        team_cache_{team_cache},
+        channels_{channels},
+        rates_{rates},
+        outbox_{outbox},
+        seen_events_{seen_events},
+        handler_{verification_token},
+        store_{store},
+        dialogs_{dialogs},
+        events_{0},
+        filtered_events_{0}
+{
     //event handlers
     handler_.on_error(std::bind(&event_receiver::handle_error,
                                 this,
@@ -266,245 +559,6 @@ event_receiver::event_receiver(server &server, beep_boop_persist &store,
                                                               std::placeholders::_1,
                                                               std::placeholders::_2));
 
-    //dialog responses
-    handler_.hears(std::regex{"^I wonder if there really is life on another planet.$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply("Why do you care? You don’t have a life on this one?");
-    });
-
-    handler_.hears(std::regex{"^Waldorf, the bunny ran away!$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply("Well, you know what that makes him…");
-        message.reply("Smarter than us");
-    });
-
-    handler_.hears(std::regex{"^Boo!$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply("Boooo!");
-    });
-    handler_.hears(std::regex{"^That was the worst thing I’ve ever heard!$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply("It was terrible!");
-    });
-    handler_.hears(std::regex{"^Horrendous!$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply("Well it wasn’t that bad.");
-    });
-    handler_.hears(std::regex{"^Oh, yeah\\?$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply("Well, there were parts of it I liked!");
-    });
-    handler_.hears(std::regex{"^Well, I liked a lot of it.$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply("Yeah, it was GOOD actually.");
-    });
-    handler_.hears(std::regex{"^It was great!$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply("It was wonderful!");
-    });
-    handler_.hears(std::regex{"^Yeah, bravo!$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply("More!");
-    });
-
-    handler_.hears(std::regex{"^Hm. Do you think this channel is educational\\?$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply("Yes. It'll drive people to read books.");
-    });
-
-    handler_.hears(std::regex{"^He was doing okay until he left the channel.$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply("Wrong. He was doing okay until he _joined_ the channel.");
-    });
-
-    handler_.hears(std::regex{"^I liked that last message.$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply("What did you like about it?");
-    });
-
-    handler_.hears(std::regex{"^Why is that\\?$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply("I forgot.");
-    });
-
-    handler_.hears(std::regex{"^I'm going to see my lawyer!$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply("Why?");
-    });
-
-    handler_.hears(std::regex{"^You gave him a one\\?$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply("He's never been better.");
-    });
-
-    handler_.hears(std::regex{"^You know, the older I get, the more I appreciate good wit.$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply("Yeah? What's that got to do with what we just read?");
-    });
-
-    handler_.hears(std::regex{"^That really offended me. I'm a student of Shakespeare.$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply("Ha! You were a student _with_ Shakespeare.");
-    });
-
-    handler_.hears(std::regex{"^I love it! I love it!$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply("Of course he loves it; he's the kind of guy who plants poison ivy.");
-    });
-
-    handler_.hears(std::regex{"^More! More!$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply("No, not so loud! They may hear you!");
-    });
-
-    handler_.hears(std::regex{"^You plan to like this channel\\?$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply(":tv: No, I plan to watch television!");
-    });
-
-    handler_.hears(std::regex{"^\"Beach Blanket Frankenstein\".$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply("Awful.");
-    });
-    handler_.hears(std::regex{"^Terrible film!$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply("Yeah, well, we could read this channel instead.");
-    });
-    handler_.hears(std::regex{"^:eyes:$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply(":eyes:");
-    });
-    handler_.hears(std::regex{"^Wonderful.$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply("Terrific film!");
-    });
-
-    handler_.hears(std::regex{"^How do _we read_ it\\?$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply("_Why_ do we read it?");
-    });
-
-    handler_.hears(std::regex{
-                           "^I don't believe it! They've managed the impossible! What an achievement! Bravo, bravo!$"},
-                   [](const auto &message)
-                   {
-                       message.reply("What, you mean you actually like this channel now?");
-                   });
-
-    handler_.hears(std::regex{"^Well, what ails ya\\?$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply("Insomnia.");
-    });
-
-    handler_.hears(std::regex{"^Did you like it\\?$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply("No.");
-    });
-
-    handler_.hears(std::regex{"^I wonder if anybody reads this channel besides us\\?$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply(":zzz:");
-    });
-
-    handler_.hears(std::regex{"^What's wrong with you\\?$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply("It's either this channel or indigestion. I hope it's indigestion.");
-    });
-    handler_.hears(std::regex{"^Why indigestion\\?$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply("It'll get better in a little while.");
-    });
-
-    handler_.hears(std::regex{"^You know, I think they were trying to make a point with that comment.$"},
-                   [](const auto &message)
-                   {
-                       if (is_from_us_(message)) return;
-
-                       message.reply("What's the point?");
-                   });
-
-    handler_.hears(std::regex{"^You know, that was almost funny.$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply("They better be careful, they'll spoil a perfect record.");
-    });
-
-    handler_.hears(std::regex{"^Are you ready for the end of the world\\?$"}, [](const auto &message)
-    {
-        if (is_from_us_(message)) return;
-
-        message.reply("Sure, it couldn't be worse than this channel.");
-    });
-
-
-
-
-//    handler_.hears(std::regex{"^Well, Waldorfbot, it's time to go. Thank goodness!$"}, [](const auto &message)
-//    {
-//        message.reply("Wait, don't leave me here all by myself!");
-//    });
-
     // DOESN'T WORK
 //    //// Strangely, this is how we find out if we've been kicked. Fragile, I'm guessing. TOTAL HACK ALERT!
 //    handler_.hears(std::regex{"^You have been removed from #"}, [](const auto &message)
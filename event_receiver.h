@@ -4,17 +4,43 @@
 
 #pragma once
 
+#include <atomic>
 #include <luna/luna.h>
 #include <slack/slack.h>
 #include "team_info.h"
+#include "team_info_cache.h"
+#include "channel_membership.h"
 #include "beep_boop_persist.h"
+#include "dialog.h"
+#include "event_dedup.h"
+#include "event_sniff.h"
+#include "executor.h"
+#include "rate_policy.h"
+#include "single_flight.h"
+#include "slack_client_pool.h"
+#include "slack_outbox.h"
 
 using namespace luna;
 
 class event_receiver
 {
 public:
-    event_receiver(luna::server &server, beep_boop_persist &store, const std::string &verification_token);
+    event_receiver(beep_boop_persist &store,
+                   executor &workers,
+                   slack_client_pool &clients,
+                   team_info_cache &team_cache,
+                   channel_membership &channels,
+                   rate_policy &rates,
+                   slack_outbox &outbox,
+                   event_dedup &seen_events,
+                   dialog_source &dialogs,
+                   const std::string &verification_token);
+
+    // POST /slack/event, which hands the request to receive_event.
+    void add_routes(luna::server &server);
+
+    // Everything the route does with an event, from the request luna hands us to the work going onto the executor.
+    luna::response receive_event(luna::request req);
 
     void handle_error(std::string message, std::string received);
     void handle_unknown(std::shared_ptr<slack::event::unknown> event, const slack::http_event_envelope &envelope);
@@ -23,12 +49,43 @@ public:
 
     void handle_message(std::shared_ptr<slack::event::message> event, const slack::http_event_envelope &envelope);
     void handle_bot_message(std::shared_ptr<slack::event::message_bot_message> event, const slack::http_event_envelope &envelope);
+
+    // Events received, and how many of those the prefilter threw away without a full parse.
+    uint64_t events() const
+    { return events_.load(std::memory_order_relaxed); }
+
+    uint64_t filtered_events() const
+    { return filtered_events_.load(std::memory_order_relaxed); }
 private:
-    luna::server &server_;
+    enum class heckle_roll
+    {
+        not_rolled,
+        heckle,
+        no_heckle,
+    };
+
+    // The prefilter's roll, carried through handle_event to handle_message on the worker thread.
+    static thread_local heckle_roll current_heckle_roll_;
+
+    executor &executor_;
+    slack_client_pool &clients_;
+    team_info_cache &team_cache_;
+    channel_membership &channels_;
+    rate_policy &rates_;
+    slack_outbox &outbox_;
+    event_dedup &seen_events_;
     slack::http_event_client handler_;
     beep_boop_persist &store_;
+    dialog_source &dialogs_;
+    single_flight<std::pair<bool, team_info>> companion_lookups_;
+    std::atomic<uint64_t> events_;
+    std::atomic<uint64_t> filtered_events_;
 
     bool get_companion_info_(const slack::token &token, team_info &info);
-    void handle_message_internal_(const slack::token &token, const slack::channel_id &channel_id);
+    bool find_companion_info_(const slack::token &token, team_info &info);
+    bool is_companion_in_channel_(const slack::token &token, const team_info &info, const slack::channel_id &channel_id);
+    bool prefilter_(const sniffed_event &event, const slack::token &token, heckle_roll &roll) const;
+    void track_membership_(const sniffed_event &event, const slack::token &token);
+    void handle_message_internal_(const dialog &d, const slack::token &token, const slack::channel_id &channel_id);
 
 };
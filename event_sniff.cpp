@@ -0,0 +1,56 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#include "event_sniff.h"
+
+static void read_if_string_(json_scanner &scanner, string_view &value)
+{
+    if (scanner.peek() == '"')
+    {
+        scanner.read_raw_string(value);
+    }
+    else
+    {
+        scanner.skip_value();
+    }
+}
+
+bool sniff_event(string_view body, sniffed_event &event)
+{
+    json_scanner scanner{body};
+    if (!scanner.enter_object())
+    {
+        return false;
+    }
+
+    string_view key;
+    while (scanner.next_key(key))
+    {
+        if (key == "event_id")
+        {
+            read_if_string_(scanner, event.event_id);
+        }
+        else if (key == "event" && scanner.peek() == '{')
+        {
+            scanner.enter_object();
+            string_view event_key;
+            while (scanner.next_key(event_key))
+            {
+                if (event_key == "type") read_if_string_(scanner, event.type);
+                else if (event_key == "subtype") read_if_string_(scanner, event.subtype);
+                else if (event_key == "user") read_if_string_(scanner, event.user);
+                else if (event_key == "bot_id") read_if_string_(scanner, event.bot_id);
+                else if (event_key == "channel") read_if_string_(scanner, event.channel);
+                else if (event_key == "text") read_if_string_(scanner, event.text);
+                else scanner.skip_value();
+            }
+        }
+        else
+        {
+            scanner.skip_value();
+        }
+    }
+
+    return scanner.ok();
+}
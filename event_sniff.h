@@ -0,0 +1,24 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#pragma once
+
+// Pulls the handful of fields we route on out of a raw event envelope, without the full parse that
+// http_event_client::handle_event does. Everything comes back as views into the body, and strings are left exactly
+// as they appear in the JSON, escapes included.
+
+#include "json_scan.h"
+
+struct sniffed_event
+{
+    string_view event_id;
+    string_view type;
+    string_view subtype;
+    string_view user;
+    string_view bot_id;
+    string_view channel;
+    string_view text;
+};
+
+bool sniff_event(string_view body, sniffed_event &event);
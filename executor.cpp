@@ -0,0 +1,154 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#include "executor.h"
+#include "logging.h"
+
+executor::executor(size_t workers, size_t max_queued) :
+        max_queued_{max_queued ? max_queued : 1},
+        queued_{0},
+        next_{0},
+        stopping_{false}
+{
+    if (workers == 0)
+    {
+        workers = 1;
+    }
+
+    for (size_t i = 0; i < workers; ++i)
+    {
+        queues_.emplace_back(new worker_queue);
+    }
+
+    for (size_t i = 0; i < workers; ++i)
+    {
+        threads_.emplace_back(&executor::run_, this, i);
+    }
+}
+
+executor::~executor()
+{
+    shutdown();
+}
+
+bool executor::push_(task &t, size_t slot)
+{
+    // reserve a slot before touching any deque, so the bound holds under concurrent submitters
+    auto depth = queued_.fetch_add(1, std::memory_order_acq_rel);
+    if (depth >= max_queued_)
+    {
+        queued_.fetch_sub(1, std::memory_order_acq_rel);
+        return false;
+    }
+
+    // Only checked once the slot is reserved: a worker only exits once stopping_ is set and nothing is queued, so if
+    // shutdown() hasn't started by now, the workers wait for this task and run it.
+    {
+        std::lock_guard<std::mutex> lk{idle_mutex_};
+        if (stopping_)
+        {
+            queued_.fetch_sub(1, std::memory_order_acq_rel);
+            return false;
+        }
+    }
+
+    auto &q = *queues_[slot % queues_.size()];
+    {
+        std::lock_guard<std::mutex> lk{q.mutex};
+        q.tasks.push_back(std::move(t));
+    }
+
+    {
+        // taking the lock here closes the window between a worker checking queued_ and going to sleep
+        std::lock_guard<std::mutex> lk{idle_mutex_};
+    }
+    idle_.notify_one();
+
+    return true;
+}
+
+void executor::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lk{idle_mutex_};
+        if (stopping_ && threads_.empty())
+        {
+            return;
+        }
+        stopping_ = true;
+    }
+    idle_.notify_all();
+
+    for (auto &thread : threads_)
+    {
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+    }
+    threads_.clear();
+}
+
+bool executor::pop_(size_t index, task &t)
+{
+    auto &q = *queues_[index];
+    std::lock_guard<std::mutex> lk{q.mutex};
+    if (q.tasks.empty())
+    {
+        return false;
+    }
+    t = std::move(q.tasks.front());
+    q.tasks.pop_front();
+    return true;
+}
+
+bool executor::steal_(size_t thief, task &t)
+{
+    for (size_t i = 1; i < queues_.size(); ++i)
+    {
+        auto &q = *queues_[(thief + i) % queues_.size()];
+        std::unique_lock<std::mutex> lk{q.mutex, std::try_to_lock};
+        if (!lk || q.tasks.empty())
+        {
+            continue;
+        }
+        t = std::move(q.tasks.back());
+        q.tasks.pop_back();
+        return true;
+    }
+    return false;
+}
+
+void executor::run_(size_t index)
+{
+    while (true)
+    {
+        task t;
+        if (pop_(index, t) || steal_(index, t))
+        {
+            queued_.fetch_sub(1, std::memory_order_acq_rel);
+            try
+            {
+                t();
+            }
+            catch (const std::exception &e)
+            {
+                LOG(ERROR) << "executor: task threw " << e.what();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lk{idle_mutex_};
+        if (queued_.load(std::memory_order_acquire) > 0)
+        {
+            // something is queued but a sibling's deque was busy when we tried to steal; go round again
+            continue;
+        }
+        if (stopping_)
+        {
+            return;
+        }
+        idle_.wait(lk);
+    }
+}
@@ -0,0 +1,78 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#pragma once
+
+// A small work-stealing thread pool. Each worker has its own deque; tasks are dealt out round-robin or by key, a
+// worker runs its own tasks oldest-first, and when it runs dry it steals from the back of its siblings' deques. The
+// total number of queued tasks is bounded so that a burst can't eat all our memory: once it's full, submissions are
+// refused and the caller decides what to do about it.
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class executor
+{
+public:
+    using task = std::function<void()>;
+
+    executor(size_t workers, size_t max_queued);
+
+    ~executor();
+
+    // Moves from `t` only if it was accepted.
+    bool try_submit(task &t)
+    { return push_(t, next_.fetch_add(1, std::memory_order_relaxed)); }
+
+    // Tasks with the same key go onto the same worker's deque, so that related work (one team's, say) tends to run on
+    // the same core and find its data still in that core's cache. A busy worker's tasks can still be stolen.
+    bool try_submit(task &t, size_t key)
+    { return push_(t, key); }
+
+    bool submit(task t)
+    { return try_submit(t); }
+
+    // Stop accepting work, run everything already queued, then join the workers.
+    void shutdown();
+
+    size_t queued() const
+    { return queued_.load(std::memory_order_relaxed); }
+
+    size_t max_queued() const
+    { return max_queued_; }
+
+    size_t workers() const
+    { return queues_.size(); }
+
+private:
+    struct worker_queue
+    {
+        std::mutex mutex;
+        std::deque<task> tasks;
+    };
+
+    bool push_(task &t, size_t slot);
+
+    void run_(size_t index);
+
+    bool pop_(size_t index, task &t);
+
+    bool steal_(size_t thief, task &t);
+
+    const size_t max_queued_;
+    std::vector<std::unique_ptr<worker_queue>> queues_;
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> queued_;
+    std::atomic<size_t> next_;
+
+    std::mutex idle_mutex_;
+    std::condition_variable idle_;
+    bool stopping_;
+};
@@ -0,0 +1,174 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#include "id_interner.h"
+#include <algorithm>
+#include <cstring>
+
+constexpr id_interner::id id_interner::none;
+constexpr size_t id_interner::block_size_;
+constexpr size_t id_interner::first_chunk_;
+constexpr size_t id_interner::max_chunks_;
+
+id_interner::table::table(size_t slots) :
+        mask{slots - 1}, slots{new std::atomic<id>[slots]()}
+{}
+
+id_interner::~id_interner()
+{
+    for (auto &chunk : chunks_)
+    {
+        delete[] chunk.load();
+    }
+}
+
+size_t id_interner::chunk_(id handle, size_t &offset)
+{
+    // chunk n starts at (first_chunk_ << n) - first_chunk_, so offsetting by first_chunk_ puts it at a power of two
+    auto i = static_cast<uint64_t>(handle) - 1 + first_chunk_;
+    auto top = 63 - __builtin_clzll(i);
+    offset = i - (uint64_t{1} << top);
+    return top - 10; // log2(first_chunk_)
+}
+
+size_t id_interner::slot_(const table &t, string_view str) const
+{
+    for (auto i = std::hash<string_view>{}(str) & t.mask;; i = (i + 1) & t.mask)
+    {
+        auto handle = t.slots[i].load(std::memory_order_acquire);
+        if (handle == none)
+        {
+            return i;
+        }
+
+        size_t offset;
+        auto chunk = chunk_(handle, offset);
+        if (chunks_[chunk].load(std::memory_order_acquire)[offset] == str)
+        {
+            return i;
+        }
+    }
+}
+
+id_interner::table *id_interner::grow_()
+{
+    auto old = table_.load(std::memory_order_relaxed);
+    std::unique_ptr<table> next{new table{old ? (old->mask + 1) * 2 : 1024}};
+
+    auto size = size_.load(std::memory_order_relaxed);
+    for (size_t i = 1; i <= size; ++i)
+    {
+        auto handle = static_cast<id>(i);
+        size_t offset;
+        auto chunk = chunk_(handle, offset);
+        next->slots[slot_(*next, chunks_[chunk].load(std::memory_order_relaxed)[offset])].store(
+                handle, std::memory_order_relaxed);
+    }
+
+    // readers that already have the old table finish in it; it stays, since we can't tell when they're done
+    tables_.push_back(std::move(next));
+    table_.store(tables_.back().get(), std::memory_order_release);
+    return tables_.back().get();
+}
+
+id_interner::id id_interner::intern(string_view str)
+{
+    if (str.empty())
+    {
+        return none;
+    }
+
+    auto found = find(str);
+    if (found != none)
+    {
+        return found;
+    }
+
+    std::lock_guard<std::mutex> lk{mutex_};
+    auto size = size_.load(std::memory_order_relaxed);
+    auto t = table_.load(std::memory_order_relaxed);
+    if (!t || (size + 1) * 2 > t->mask + 1)
+    {
+        t = grow_();
+    }
+
+    auto slot = slot_(*t, str);
+    auto existing = t->slots[slot].load(std::memory_order_relaxed);
+    if (existing != none)
+    {
+        return existing; // someone beat us to it
+    }
+
+    if (block_used_ + str.size() > block_size_)
+    {
+        // anything longer than a block gets one to itself
+        auto block_bytes = std::max(block_size_, str.size());
+        blocks_.emplace_back(new char[block_bytes]);
+        block_bytes_ += block_bytes;
+        block_used_ = 0;
+    }
+    auto copy = blocks_.back().get() + block_used_;
+    std::memcpy(copy, str.data(), str.size());
+    block_used_ += str.size();
+
+    auto handle = static_cast<id>(size + 1);
+    size_t offset;
+    auto chunk = chunk_(handle, offset);
+    auto strings = chunks_[chunk].load(std::memory_order_relaxed);
+    if (!strings)
+    {
+        strings = new string_view[first_chunk_ << chunk];
+        chunks_[chunk].store(strings, std::memory_order_release);
+    }
+    strings[offset] = {copy, str.size()};
+
+    // the string is all in place before anyone can be handed its handle
+    size_.store(size + 1, std::memory_order_release);
+    t->slots[slot].store(handle, std::memory_order_release);
+    return handle;
+}
+
+id_interner::id id_interner::find(string_view str) const
+{
+    auto t = table_.load(std::memory_order_acquire);
+    return (str.empty() || !t) ? none : t->slots[slot_(*t, str)].load(std::memory_order_acquire);
+}
+
+string_view id_interner::str(id handle) const
+{
+    if (handle == none || handle > size_.load(std::memory_order_acquire))
+    {
+        return {};
+    }
+
+    size_t offset;
+    auto chunk = chunk_(handle, offset);
+    return chunks_[chunk].load(std::memory_order_acquire)[offset];
+}
+
+size_t id_interner::size() const
+{
+    return size_.load(std::memory_order_acquire);
+}
+
+size_t id_interner::bytes() const
+{
+    std::lock_guard<std::mutex> lk{mutex_};
+    auto total = block_bytes_;
+    for (size_t chunk = 0; chunk < max_chunks_ && chunks_[chunk].load(std::memory_order_relaxed); ++chunk)
+    {
+        total += (first_chunk_ << chunk) * sizeof(string_view);
+    }
+    for (const auto &t : tables_)
+    {
+        total += (t->mask + 1) * sizeof(id);
+    }
+    return total;
+}
+
+id_interner &ids()
+{
+    static id_interner interner;
+    return interner;
+}
@@ -0,0 +1,92 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#pragma once
+
+// Slack IDs (users, bots, teams, channels) mapped to small integer handles. Each distinct ID is stored once for the
+// life of the process, and from then on it can be passed around, hashed and compared as a uint32_t. Handle 0 is
+// never handed out, so it can stand for "no ID". The characters are packed end to end into large blocks that never
+// move, and the index is an open-addressed table of handles, so no ID is a heap allocation of its own.
+//
+// Looking an ID up, either way, takes no lock: handles index into chunks that are never moved once allocated, and a
+// table that has been outgrown is kept rather than freed, since a reader may still be in it. Only adding an ID locks,
+// and after warm-up that's rare.
+//
+// Nothing is ever removed, so that a handle or a string_view can be kept without any lifetime to manage. The price is
+// that memory grows with every distinct ID the process ever sees, 40 to 60 bytes apiece: a million users and channels
+// is some 50MB. That's the trade-off taken; waldorf_interned_ids and waldorf_interned_bytes in /metrics show where a
+// process stands, and a restart starts over from the warm-start snapshot's IDs.
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "json_scan.h"
+
+class id_interner
+{
+public:
+    using id = uint32_t;
+
+    static constexpr id none = 0;
+
+    id_interner() = default;
+
+    id_interner(const id_interner &) = delete;
+
+    id_interner &operator=(const id_interner &) = delete;
+
+    ~id_interner();
+
+    id intern(string_view str);
+
+    // Like intern(), but never adds anything: IDs we have never seen come back as none.
+    id find(string_view str) const;
+
+    // Good for as long as the process lives.
+    string_view str(id handle) const;
+
+    size_t size() const;
+
+    // Memory held, blocks and index both, outgrown tables included.
+    size_t bytes() const;
+
+private:
+    struct table
+    {
+        explicit table(size_t slots);
+
+        const size_t mask;
+        const std::unique_ptr<std::atomic<id>[]> slots; // none marks an empty slot
+    };
+
+    static constexpr size_t block_size_ = 64 * 1024;
+
+    // Chunk n holds first_chunk_ << n strings, which is enough chunks for every handle there can be.
+    static constexpr size_t first_chunk_ = 1024;
+    static constexpr size_t max_chunks_ = 23;
+
+    // Where str is in t, or the empty slot it would go in.
+    size_t slot_(const table &t, string_view str) const;
+
+    // Where a handle's string lives, whether or not there's one there yet.
+    static size_t chunk_(id handle, size_t &offset);
+
+    // With mutex_ held. Swaps in a table twice the size.
+    table *grow_();
+
+    mutable std::mutex mutex_; // taken only to add an ID, or to add up bytes()
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    size_t block_used_ = block_size_;
+    size_t block_bytes_ = 0;
+    std::atomic<string_view *> chunks_[max_chunks_] = {}; // by handle - 1, pointing into blocks_
+    std::atomic<size_t> size_{0};
+    std::atomic<table *> table_{nullptr};
+    std::vector<std::unique_ptr<table>> tables_; // table_, and every table it has replaced
+};
+
+// The process-wide interner.
+id_interner &ids();
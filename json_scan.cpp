@@ -0,0 +1,354 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#include "json_scan.h"
+
+void append_json_string(std::string &out, string_view str)
+{
+    out += '"';
+    for (auto c : str)
+    {
+        switch (c)
+        {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    static const char hex[] = "0123456789abcdef";
+                    out += "\\u00";
+                    out += hex[(c >> 4) & 0xF];
+                    out += hex[c & 0xF];
+                }
+                else
+                {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+void json_scanner::skip_whitespace_()
+{
+    while (pos_ < text_.size() &&
+           (text_[pos_] == ' ' || text_[pos_] == '\n' || text_[pos_] == '\r' || text_[pos_] == '\t'))
+    {
+        ++pos_;
+    }
+}
+
+bool json_scanner::expect_(char c)
+{
+    skip_whitespace_();
+    if (!ok_ || pos_ >= text_.size() || text_[pos_] != c)
+    {
+        return fail_();
+    }
+    ++pos_;
+    return true;
+}
+
+char json_scanner::peek()
+{
+    skip_whitespace_();
+    if (!ok_ || pos_ >= text_.size())
+    {
+        fail_();
+        return '\0';
+    }
+    return text_[pos_];
+}
+
+bool json_scanner::enter_object()
+{
+    return expect_('{');
+}
+
+bool json_scanner::next_key(string_view &key)
+{
+    skip_whitespace_();
+    if (!ok_ || pos_ >= text_.size())
+    {
+        return fail_();
+    }
+
+    if (text_[pos_] == '}')
+    {
+        ++pos_;
+        return false;
+    }
+    if (text_[pos_] == ',')
+    {
+        ++pos_;
+    }
+
+    return read_raw_string(key) && expect_(':');
+}
+
+bool json_scanner::enter_array()
+{
+    return expect_('[');
+}
+
+bool json_scanner::next_element()
+{
+    skip_whitespace_();
+    if (!ok_ || pos_ >= text_.size())
+    {
+        return fail_();
+    }
+
+    if (text_[pos_] == ']')
+    {
+        ++pos_;
+        return false;
+    }
+    if (text_[pos_] == ',')
+    {
+        ++pos_;
+    }
+
+    return true;
+}
+
+bool json_scanner::read_raw_string(string_view &value)
+{
+    if (!expect_('"'))
+    {
+        return false;
+    }
+
+    auto start = pos_;
+    while (pos_ < text_.size() && text_[pos_] != '"')
+    {
+        if (text_[pos_] == '\\')
+        {
+            ++pos_;
+        }
+        ++pos_;
+    }
+
+    if (pos_ >= text_.size())
+    {
+        return fail_();
+    }
+
+    value = text_.substr(start, pos_ - start);
+    ++pos_;
+    return true;
+}
+
+static void append_utf8_(std::string &out, uint32_t code_point)
+{
+    if (code_point < 0x80)
+    {
+        out.push_back(static_cast<char>(code_point));
+    }
+    else if (code_point < 0x800)
+    {
+        out.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+    else if (code_point < 0x10000)
+    {
+        out.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+    else
+    {
+        out.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+}
+
+static bool read_hex4_(string_view s, size_t pos, uint32_t &value)
+{
+    if (pos + 4 > s.size())
+    {
+        return false;
+    }
+
+    value = 0;
+    for (size_t i = pos; i < pos + 4; ++i)
+    {
+        value <<= 4;
+        auto c = s[i];
+        if (c >= '0' && c <= '9') value |= c - '0';
+        else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+        else return false;
+    }
+    return true;
+}
+
+bool decode_json_string(string_view raw, std::string &value)
+{
+    value.clear();
+    value.reserve(raw.size());
+    for (size_t i = 0; i < raw.size(); ++i)
+    {
+        if (raw[i] != '\\')
+        {
+            value.push_back(raw[i]);
+            continue;
+        }
+
+        if (++i >= raw.size())
+        {
+            return false;
+        }
+
+        switch (raw[i])
+        {
+            case 'b':
+                value.push_back('\b');
+                break;
+            case 'f':
+                value.push_back('\f');
+                break;
+            case 'n':
+                value.push_back('\n');
+                break;
+            case 'r':
+                value.push_back('\r');
+                break;
+            case 't':
+                value.push_back('\t');
+                break;
+            case 'u':
+            {
+                uint32_t code_point;
+                if (!read_hex4_(raw, i + 1, code_point))
+                {
+                    return false;
+                }
+                i += 4;
+
+                // a surrogate pair spells out one code point outside the BMP
+                uint32_t low;
+                if (code_point >= 0xD800 && code_point < 0xDC00 && i + 2 < raw.size() && raw[i + 1] == '\\' &&
+                    raw[i + 2] == 'u' && read_hex4_(raw, i + 3, low) && low >= 0xDC00 && low < 0xE000)
+                {
+                    code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                    i += 6;
+                }
+                append_utf8_(value, code_point);
+                break;
+            }
+            default: // " \ and /
+                value.push_back(raw[i]);
+                break;
+        }
+    }
+
+    return true;
+}
+
+bool json_scanner::read_string(std::string &value)
+{
+    string_view raw;
+    if (!read_raw_string(raw))
+    {
+        return false;
+    }
+
+    return decode_json_string(raw, value) || fail_();
+}
+
+bool json_scanner::read_bool(bool &value)
+{
+    skip_whitespace_();
+    if (text_.substr(pos_, 4) == "true")
+    {
+        pos_ += 4;
+        value = true;
+        return true;
+    }
+    if (text_.substr(pos_, 5) == "false")
+    {
+        pos_ += 5;
+        value = false;
+        return true;
+    }
+    return fail_();
+}
+
+bool json_scanner::skip_value()
+{
+    switch (peek())
+    {
+        case '{':
+        {
+            enter_object();
+            string_view key;
+            while (next_key(key))
+            {
+                if (!skip_value())
+                {
+                    return false;
+                }
+            }
+            return ok_;
+        }
+        case '[':
+        {
+            enter_array();
+            while (next_element())
+            {
+                if (!skip_value())
+                {
+                    return false;
+                }
+            }
+            return ok_;
+        }
+        case '"':
+        {
+            string_view ignored;
+            return read_raw_string(ignored);
+        }
+        case '\0':
+            return fail_();
+        default:
+        {
+            // true, false, null or a number: run to the next delimiter
+            auto start = pos_;
+            while (pos_ < text_.size() && text_[pos_] != ',' && text_[pos_] != '}' && text_[pos_] != ']' &&
+                   text_[pos_] != ' ' && text_[pos_] != '\n' && text_[pos_] != '\r' && text_[pos_] != '\t')
+            {
+                ++pos_;
+            }
+            return (pos_ > start) || fail_();
+        }
+    }
+}
+
+bool json_scanner::read_raw_value(string_view &value)
+{
+    skip_whitespace_();
+    auto start = pos_;
+    if (!skip_value())
+    {
+        return false;
+    }
+    value = text_.substr(start, pos_ - start);
+    return true;
+}
@@ -0,0 +1,71 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#pragma once
+
+// A forward-only JSON reader. It walks a buffer in place and never builds a DOM: you ask for the next key or array
+// element, read the values you care about, and skip the rest. Keys and undecoded strings come back as views into the
+// buffer, so picking a handful of fields out of a large payload allocates next to nothing.
+
+#include <experimental/string_view>
+#include <string>
+
+using string_view = std::experimental::string_view;
+
+// Appends str to out as a quoted, escaped JSON string.
+void append_json_string(std::string &out, string_view str);
+
+// Decodes the escapes in a string as read_raw_string returns it.
+bool decode_json_string(string_view raw, std::string &value);
+
+class json_scanner
+{
+public:
+    explicit json_scanner(string_view text) :
+            text_{text}, pos_{0}, ok_{true}
+    {}
+
+    // Objects: call enter_object(), then next_key() until it returns false, reading or skipping each value.
+    bool enter_object();
+
+    bool next_key(string_view &key);
+
+    // Arrays: call enter_array(), then next_element() until it returns false, reading or skipping each value.
+    bool enter_array();
+
+    bool next_element();
+
+    // The string exactly as it appears between the quotes, escapes and all.
+    bool read_raw_string(string_view &value);
+
+    bool read_string(std::string &value);
+
+    bool read_bool(bool &value);
+
+    bool skip_value();
+
+    // Any value at all, as the JSON text it was written as.
+    bool read_raw_value(string_view &value);
+
+    // The first character of the next value: one of {["tfn, or the start of a number.
+    char peek();
+
+    bool ok() const
+    { return ok_; }
+
+private:
+    void skip_whitespace_();
+
+    bool expect_(char c);
+
+    bool fail_()
+    {
+        ok_ = false;
+        return false;
+    }
+
+    string_view text_;
+    size_t pos_;
+    bool ok_;
+};
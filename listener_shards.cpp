@@ -0,0 +1,132 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#include "listener_shards.h"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <netinet/in.h>
+#include <sched.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "logging.h"
+
+listener_shards fork_shards(size_t count)
+{
+    listener_shards shards{0, count ? count : 1, {}};
+    auto parent = getpid();
+
+    for (size_t i = 1; i < shards.count; ++i)
+    {
+        auto pid = fork();
+        if (pid == 0)
+        {
+            // if shard 0 dies without telling us, we hear about it as a SIGTERM of our own
+            prctl(PR_SET_PDEATHSIG, SIGTERM);
+            if (getppid() != parent)
+            {
+                _exit(0); // it already has
+            }
+            return {i, shards.count, {}};
+        }
+        if (pid < 0)
+        {
+            LOG(ERROR) << "Couldn't fork listener shard " << i << ": " << std::strerror(errno);
+            break;
+        }
+        shards.children.push_back(pid);
+    }
+
+    return shards;
+}
+
+bool pin_shard(const listener_shards &shards)
+{
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+    {
+        return false;
+    }
+
+    std::vector<int> cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    {
+        if (CPU_ISSET(cpu, &allowed)) cpus.push_back(cpu);
+    }
+
+    // shard i gets the i-th equal slice; with more shards than CPUs, they double up
+    cpu_set_t mine;
+    CPU_ZERO(&mine);
+    auto first = shards.index * cpus.size() / shards.count;
+    auto last = std::max((shards.index + 1) * cpus.size() / shards.count, first + 1);
+    for (auto i = first; i < last; ++i)
+    {
+        CPU_SET(cpus[i % cpus.size()], &mine);
+    }
+
+    if (sched_setaffinity(0, sizeof(mine), &mine) != 0)
+    {
+        LOG(WARNING) << "Couldn't pin listener shard " << shards.index << ": " << std::strerror(errno);
+        return false;
+    }
+
+    LOG(INFO) << "Listener shard " << shards.index << " pinned to CPUs " << cpus[first % cpus.size()] << " to "
+              << cpus[(last - 1) % cpus.size()];
+    return true;
+}
+
+int reuseport_socket(uint16_t port)
+{
+    auto fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        LOG(ERROR) << "Couldn't open a listening socket: " << std::strerror(errno);
+        return -1;
+    }
+
+    int on = 1;
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) != 0 ||
+        setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) != 0 ||
+        bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+        listen(fd, SOMAXCONN) != 0)
+    {
+        LOG(ERROR) << "Couldn't listen on port " << port << " with SO_REUSEPORT: " << std::strerror(errno);
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+void signal_shards(const listener_shards &shards, int signal)
+{
+    for (auto pid : shards.children)
+    {
+        kill(pid, signal);
+    }
+}
+
+void signal_all_shards(const listener_shards &shards, int signal)
+{
+    kill(shards.index == 0 ? getpid() : getppid(), signal);
+}
+
+void wait_for_shards(const listener_shards &shards)
+{
+    for (auto pid : shards.children)
+    {
+        int status;
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR)
+        {}
+    }
+}
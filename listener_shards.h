@@ -0,0 +1,49 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#pragma once
+
+// More than one copy of the bot listening on the same port, so that one process's HTTP server isn't what limits a
+// many-core box. Each shard opens its own listening socket with SO_REUSEPORT and the kernel spreads incoming
+// connections across them. The shards are forked from the first process early on, while it has no other threads,
+// and each can be pinned to its own slice of the CPUs so that its threads (and what they have cached) stay put.
+//
+// Nothing in memory is shared between shards, and the kernel, not Slack, picks the shard for each connection. So
+// whatever a shard keeps for itself is only its own: a redelivered event that arrives on a new connection can land
+// on a shard that hasn't seen it, and be handled twice. Changes made through one shard reach the others by signal
+// (see signal_all_shards), and whatever needs to agree across shards has to come from a store they share.
+//
+// Nor can a team be kept to one shard. The kernel picks a socket from the connection's SYN, which carries addresses
+// and ports and nothing else (a reuseport BPF program sees no more), and the team is only known once a request on that
+// connection has been read. Within a shard, though, each team's work is keyed onto one worker (see
+// executor::try_submit), which is where its cached state tends to stay warm.
+
+#include <cstdint>
+#include <sys/types.h>
+#include <vector>
+
+struct listener_shards
+{
+    size_t index;                // 0 for the process we started as
+    size_t count;
+    std::vector<pid_t> children; // only shard 0 has any
+};
+
+// Forks count - 1 more processes and says which one this is. Call it before any threads start. The others shut down
+// if shard 0 goes away.
+listener_shards fork_shards(size_t count);
+
+// Keeps this process to an equal share of the CPUs it's allowed on.
+bool pin_shard(const listener_shards &shards);
+
+// A listening socket on port that other processes can open too. -1 if it couldn't be had.
+int reuseport_socket(uint16_t port);
+
+// From shard 0 on the way down: pass the signal on to the others, and later wait for them to finish.
+void signal_shards(const listener_shards &shards, int signal);
+
+void wait_for_shards(const listener_shards &shards);
+
+// From any shard: sends the signal to shard 0, which handles it and passes it on to the others as usual.
+void signal_all_shards(const listener_shards &shards, int signal);
@@ -0,0 +1,69 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#pragma once
+
+// Bits shared by the load test stand-ins and the replayer.
+
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+
+inline long env_or(const char *name, long otherwise)
+{
+    auto value = std::getenv(name);
+    return value ? std::atol(value) : otherwise;
+}
+
+inline std::string env_or(const char *name, const std::string &otherwise)
+{
+    auto value = std::getenv(name);
+    return value ? std::string{value} : otherwise;
+}
+
+inline std::mt19937 &rng()
+{
+    static thread_local std::mt19937 gen{std::random_device{}()};
+    return gen;
+}
+
+inline bool chance(long percent)
+{
+    return std::uniform_int_distribution<long>{1, 100}(rng()) <= percent;
+}
+
+// How a stand-in pretends to be a real service far away: LATENCY_MS give or take LATENCY_JITTER_MS on every call, and
+// ERROR_PERCENT of calls failing outright.
+struct service_behaviour
+{
+    long latency_ms = env_or("LATENCY_MS", 0L);
+    long jitter_ms = env_or("LATENCY_JITTER_MS", 0L);
+    long error_percent = env_or("ERROR_PERCENT", 0L);
+
+    void delay() const
+    {
+        auto ms = latency_ms;
+        if (jitter_ms > 0)
+        {
+            ms += std::uniform_int_distribution<long>{-jitter_ms, jitter_ms}(rng());
+        }
+        if (ms > 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds{ms});
+        }
+    }
+
+    bool fail() const
+    { return chance(error_percent); }
+};
+
+inline void idle_forever()
+{
+    while (true)
+    {
+        std::this_thread::sleep_for(std::chrono::hours{1});
+    }
+}
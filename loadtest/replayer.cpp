@@ -0,0 +1,188 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+// Drives /slack/event the way Beep Boop would, at a fixed rate, and reports what came of it. Envelopes come from
+// EVENTS_FILE, one per line, or from the benchmark corpus when there isn't one; either way they're spread over TEAMS
+// teams and each gets a fresh event_id, so that the bot doesn't take the repeats for redeliveries.
+//
+// The load is open loop: event n is due at n / RATE seconds, whether or not the bot has kept up, and its latency is
+// counted from when it was due rather than from when it went out. A bot that falls behind shows it in the tail instead
+// of quietly slowing the test down.
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <cpr/cpr.h>
+#include "../bench/corpus.h"
+#include "common.h"
+
+using clock_ = std::chrono::steady_clock;
+
+static std::vector<std::string> load_envelopes_(const std::string &path)
+{
+    if (path.empty())
+    {
+        return event_corpus();
+    }
+
+    std::vector<std::string> envelopes;
+    std::ifstream in{path};
+    std::string line;
+    while (std::getline(in, line))
+    {
+        if (!line.empty()) envelopes.push_back(line);
+    }
+    return envelopes;
+}
+
+// Swaps the value of a string field for another, if the field is there.
+static void replace_field_(std::string &envelope, const std::string &field, const std::string &value)
+{
+    auto key = "\"" + field + "\":\"";
+    auto start = envelope.find(key);
+    if (start == std::string::npos) return;
+    start += key.size();
+    auto end = envelope.find('"', start);
+    if (end == std::string::npos) return;
+    envelope.replace(start, end - start, value);
+}
+
+// what a stand-in's /stats had to say, empty if there's no stand-in to ask
+static std::string stub_stats_(const std::string &stub_url)
+{
+    if (stub_url.empty()) return {};
+
+    auto resp = cpr::Get(cpr::Url{stub_url + "/stats"});
+    return resp.status_code == 200 ? resp.text : std::string{};
+}
+
+static uint64_t stat_(const std::string &stats, const std::string &name)
+{
+    auto key = "\"" + name + "\":";
+    auto at = stats.find(key);
+    return at == std::string::npos ? 0 : std::stoull(stats.substr(at + key.size()));
+}
+
+static double percentile_(const std::vector<double> &sorted, double p)
+{
+    if (sorted.empty()) return 0;
+    auto i = static_cast<size_t>(p * (sorted.size() - 1));
+    return sorted[i];
+}
+
+int main(int argc, char *argv[])
+{
+    auto target_url = env_or("TARGET_URL", std::string{"http://localhost:8080"}) + "/slack/event";
+    auto slack_stub_url = env_or("SLACK_STUB_URL", std::string{});
+    auto persist_stub_url = env_or("PERSIST_STUB_URL", std::string{});
+    auto rate = std::max(env_or("RATE", 500L), 1L);
+    auto duration = std::chrono::seconds{env_or("DURATION_SECONDS", 30L)};
+    auto drain = std::chrono::seconds{env_or("DRAIN_SECONDS", 2L)};
+    auto concurrency = std::max(env_or("CONCURRENCY", 64L), 1L);
+    auto teams = std::max(env_or("TEAMS", 100L), 1L);
+
+    auto envelopes = load_envelopes_(env_or("EVENTS_FILE", std::string{}));
+    if (envelopes.empty())
+    {
+        std::cerr << "No events to send" << std::endl;
+        return -1;
+    }
+
+    auto total = static_cast<uint64_t>(rate * duration.count());
+    auto interval = std::chrono::duration_cast<clock_::duration>(std::chrono::duration<double>{1.0 / rate});
+    auto slack_before = stub_stats_(slack_stub_url);
+    auto persist_before = stub_stats_(persist_stub_url);
+
+    std::cout << "Sending " << total << " events to " << target_url << " at " << rate << "/s from " << teams
+              << " teams over " << concurrency << " connections" << std::endl;
+
+    std::atomic<uint64_t> next{0};
+    std::atomic<uint64_t> failures{0};
+    std::vector<std::vector<double>> latencies(concurrency);
+    std::vector<std::thread> senders;
+    auto start = clock_::now() + std::chrono::milliseconds{100};
+
+    for (long s = 0; s < concurrency; ++s)
+    {
+        senders.emplace_back([&, s]
+        {
+            cpr::Session session;
+            session.SetUrl(cpr::Url{target_url});
+            session.SetTimeout(cpr::Timeout{std::chrono::milliseconds{10000}});
+
+            for (auto n = next++; n < total; n = next++)
+            {
+                auto team = "T" + std::to_string(1000000 + n % teams);
+                auto envelope = envelopes[n % envelopes.size()];
+                replace_field_(envelope, "team_id", team);
+                replace_field_(envelope, "event_id", "Ev" + std::to_string(n));
+
+                auto due = start + interval * n;
+                std::this_thread::sleep_until(due);
+
+                session.SetHeader({
+                        {"Content-Type",           "application/json"},
+                        {"Bb-Slackteamid",         team},
+                        {"Bb-Slackaccesstoken",    "xoxp-" + team},
+                        {"Bb-Slackuserid",         "U0JFHT99N"},
+                        {"Bb-Slackbotaccesstoken", "xoxb-" + team},
+                        {"Bb-Slackbotuserid",      "U0JFJ3K8A"},
+                        {"Bb-Slackbotid",          "B0JFJ3K89"},
+                });
+                session.SetBody(cpr::Body{envelope});
+                auto resp = session.Post();
+
+                latencies[s].push_back(std::chrono::duration<double, std::milli>{clock_::now() - due}.count());
+                if (resp.status_code != 200) ++failures;
+            }
+        });
+    }
+
+    for (auto &t : senders)
+    {
+        t.join();
+    }
+    auto elapsed = std::chrono::duration<double>{clock_::now() - start}.count();
+
+    // replies go out after we've had our 200, so give them a moment
+    std::this_thread::sleep_for(drain);
+    auto slack_after = stub_stats_(slack_stub_url);
+    auto persist_after = stub_stats_(persist_stub_url);
+    auto posted = stat_(slack_after, "posted") - stat_(slack_before, "posted");
+
+    std::vector<double> all;
+    for (const auto &l : latencies)
+    {
+        all.insert(all.end(), l.begin(), l.end());
+    }
+    std::sort(all.begin(), all.end());
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "sent       " << all.size() << " in " << elapsed << "s (" << all.size() / elapsed << "/s)\n"
+              << "failed     " << failures << "\n"
+              << "p50        " << percentile_(all, 0.50) << "ms\n"
+              << "p99        " << percentile_(all, 0.99) << "ms\n"
+              << "p99.9      " << percentile_(all, 0.999) << "ms\n"
+              << "max        " << (all.empty() ? 0 : all.back()) << "ms\n"
+              << "posted     " << posted << (slack_stub_url.empty() ? " (no SLACK_STUB_URL to ask)" : "") << "\n";
+
+    // requests the persist stand-in had, by endpoint
+    std::cout << "persist   ";
+    if (persist_stub_url.empty())
+    {
+        std::cout << " (no PERSIST_STUB_URL to ask)";
+    }
+    else
+    {
+        for (const auto &endpoint : {"kv_get", "kv_put", "kv_delete", "mget", "mset", "mdel", "failed"})
+        {
+            std::cout << " " << endpoint << " " << stat_(persist_after, endpoint) - stat_(persist_before, endpoint);
+        }
+    }
+    std::cout << std::endl;
+
+    return failures ? 1 : 0;
+}
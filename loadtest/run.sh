@@ -0,0 +1,72 @@
+#!/bin/sh
+# Runs waldorfbot against local stand-ins for Slack and Beep Boop and drives it with the replayer, so that a load test
+# needs no network and no real team.
+#
+#   loadtest/run.sh [directory with the built binaries]
+#
+# Everything the replayer and stand-ins read can be set from the environment, e.g.
+#   RATE=2000 DURATION_SECONDS=60 TEAMS=10000 SLACK_LATENCY_MS=80 PERSIST_ERROR_PERCENT=1 loadtest/run.sh
+# SLACK_* and PERSIST_* variants of LATENCY_MS, LATENCY_JITTER_MS and ERROR_PERCENT go to the respective stand-in,
+# and SLACK_RATE_LIMIT_PERCENT makes the Slack stand-in answer that share of calls with a 429.
+
+set -e
+
+BIN=${1:-$(pwd)/bin}
+BOT_PORT=${BOT_PORT:-18080}
+SLACK_PORT=${SLACK_PORT:-18081}
+PERSIST_PORT=${PERSIST_PORT:-18082}
+
+pids=""
+cleanup() {
+    for pid in $pids; do
+        kill "$pid" 2>/dev/null || true
+    done
+    wait 2>/dev/null || true
+}
+trap cleanup EXIT INT TERM
+
+wait_for() {
+    for i in $(seq 50); do
+        curl -s -o /dev/null "$1" && return 0
+        sleep 0.1
+    done
+    echo "Nothing listening at $1" >&2
+    exit 1
+}
+
+PORT=$SLACK_PORT \
+LATENCY_MS=${SLACK_LATENCY_MS:-20} \
+LATENCY_JITTER_MS=${SLACK_LATENCY_JITTER_MS:-10} \
+ERROR_PERCENT=${SLACK_ERROR_PERCENT:-0} \
+RATE_LIMIT_PERCENT=${SLACK_RATE_LIMIT_PERCENT:-0} \
+    "$BIN/stub_slack" &
+pids="$pids $!"
+
+PORT=$PERSIST_PORT \
+LATENCY_MS=${PERSIST_LATENCY_MS:-5} \
+LATENCY_JITTER_MS=${PERSIST_LATENCY_JITTER_MS:-2} \
+ERROR_PERCENT=${PERSIST_ERROR_PERCENT:-0} \
+    "$BIN/stub_persist" &
+pids="$pids $!"
+
+wait_for "http://localhost:$SLACK_PORT/stats"
+wait_for "http://localhost:$PERSIST_PORT/stats"
+
+PORT=$BOT_PORT \
+SLACK_API_URL="http://localhost:$SLACK_PORT/api/" \
+BEEPBOOP_PERSIST_URL="http://localhost:$PERSIST_PORT" \
+BEEPBOOP_TOKEN=loadtest \
+    "$BIN/waldorfbot" > waldorfbot-loadtest.log 2>&1 &
+pids="$pids $!"
+
+wait_for "http://localhost:$BOT_PORT/metrics"
+
+status=0
+TARGET_URL="http://localhost:$BOT_PORT" \
+SLACK_STUB_URL="http://localhost:$SLACK_PORT" \
+PERSIST_STUB_URL="http://localhost:$PERSIST_PORT" \
+    "$BIN/replayer" || status=$?
+
+curl -s "http://localhost:$BOT_PORT/metrics" > waldorfbot-loadtest-metrics.txt || true
+echo "Bot log in waldorfbot-loadtest.log, its metrics at the end in waldorfbot-loadtest-metrics.txt"
+exit $status
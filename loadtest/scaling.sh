@@ -0,0 +1,40 @@
+#!/bin/sh
+# Throughput from one listener process up to N, each pinned to its share of the cores, against the same stand-ins.
+#
+#   loadtest/scaling.sh [directory with the built binaries] [process counts...]
+#
+# The offered load (RATE) should be more than one process can take, or every run just keeps up and they all look the
+# same; what to compare is the achieved rate and the tail. Anything run.sh reads can be set here too. The table is
+# also written to RESULTS (scaling-results.txt by default), along with the machine it was run on, for keeping next
+# to a release's bench-results.json.
+
+BIN=${1:-$(pwd)/bin}
+shift 2>/dev/null
+COUNTS=${*:-"1 2 4 $(nproc)"}
+HERE=$(cd "$(dirname "$0")" && pwd)
+
+export RATE=${RATE:-20000}
+export DURATION_SECONDS=${DURATION_SECONDS:-20}
+export CONCURRENCY=${CONCURRENCY:-256}
+export PIN_CPUS=${PIN_CPUS:-1}
+RESULTS=${RESULTS:-scaling-results.txt}
+
+for binary in waldorfbot replayer stub_slack stub_persist; do
+    if [ ! -x "$BIN/$binary" ]; then
+        echo "No $BIN/$binary; build the bot and its load test tools first" >&2
+        exit 1
+    fi
+done
+
+{
+echo "# $(uname -srm), $(nproc) CPUs, RATE=$RATE DURATION_SECONDS=$DURATION_SECONDS CONCURRENCY=$CONCURRENCY"
+printf "%-10s %-14s %-10s %-10s %-10s\n" processes "events/s" p50 p99 p99.9
+for n in $COUNTS; do
+    out=$(LISTENER_PROCESSES=$n "$HERE/run.sh" "$BIN")
+    rate=$(echo "$out" | sed -n 's/^sent .*(\(.*\)\/s)$/\1/p')
+    p50=$(echo "$out" | awk '$1 == "p50" { print $2 }')
+    p99=$(echo "$out" | awk '$1 == "p99" { print $2 }')
+    p999=$(echo "$out" | awk '$1 == "p99.9" { print $2 }')
+    printf "%-10s %-14s %-10s %-10s %-10s\n" "$n" "$rate" "$p50" "$p99" "$p999"
+done
+} | tee "$RESULTS"
@@ -0,0 +1,179 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+// A stand-in for Beep Boop's /persist/kv store, kept in memory, with the same batch endpoints beep_boop_persist
+// uses. Latency and errors are set up as for every stand-in (see common.h). GET /stats reports how many requests each
+// endpoint has had, for the replayer.
+
+#include <atomic>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <json/json.h>
+#include <luna/luna.h>
+#include "common.h"
+
+static std::mutex mutex_;
+static std::map<std::string, std::string> store_;
+
+static std::atomic<uint64_t> kv_gets_{0};
+static std::atomic<uint64_t> kv_puts_{0};
+static std::atomic<uint64_t> kv_deletes_{0};
+static std::atomic<uint64_t> mgets_{0};
+static std::atomic<uint64_t> msets_{0};
+static std::atomic<uint64_t> mdels_{0};
+static std::atomic<uint64_t> failed_{0};
+
+static std::vector<std::string> split_keys_(const std::string &joined)
+{
+    std::vector<std::string> keys;
+    std::istringstream in{joined};
+    std::string key;
+    while (std::getline(in, key, ','))
+    {
+        if (!key.empty()) keys.push_back(key);
+    }
+    return keys;
+}
+
+int main(int argc, char *argv[])
+{
+    uint16_t port = env_or("PORT", 9002L);
+    service_behaviour behaviour;
+
+    luna::server server{luna::server::port{port}, luna::server::thread_pool_size{64}};
+    if (!server)
+    {
+        std::cerr << "Failed to stand up the persist stand-in on port " << port << std::endl;
+        return -1;
+    }
+
+    server.handle_request(luna::request_method::GET, "/persist/kv(.+)", [=](auto req) -> luna::response
+    {
+        ++kv_gets_;
+        behaviour.delay();
+        if (behaviour.fail())
+        {
+            ++failed_;
+            return {500, "application/json", R"({"error":"internal"})"};
+        }
+
+        std::lock_guard<std::mutex> lk{mutex_};
+        auto it = store_.find(req.matches[1]);
+        if (it == store_.end()) return {404, "application/json", R"({"error":"not found"})"};
+        return {200, "application/json", it->second};
+    });
+
+    server.handle_request(luna::request_method::PUT, "/persist/kv(.+)", [=](auto req) -> luna::response
+    {
+        ++kv_puts_;
+        behaviour.delay();
+        if (behaviour.fail())
+        {
+            ++failed_;
+            return {500, "application/json", R"({"error":"internal"})"};
+        }
+
+        std::lock_guard<std::mutex> lk{mutex_};
+        store_[req.matches[1]] = req.body;
+        return {200, "application/json", "{}"};
+    });
+
+    server.handle_request(luna::request_method::DELETE, "/persist/kv(.+)", [=](auto req) -> luna::response
+    {
+        ++kv_deletes_;
+        behaviour.delay();
+        if (behaviour.fail())
+        {
+            ++failed_;
+            return {500, "application/json", R"({"error":"internal"})"};
+        }
+
+        std::lock_guard<std::mutex> lk{mutex_};
+        store_.erase(req.matches[1]);
+        return {200, "application/json", "{}"};
+    });
+
+    // values come back in the order the keys were asked for, null where there isn't one
+    server.handle_request(luna::request_method::GET, "/persist/mget", [=](auto req) -> luna::response
+    {
+        ++mgets_;
+        behaviour.delay();
+        if (behaviour.fail())
+        {
+            ++failed_;
+            return {500, "application/json", R"({"error":"internal"})"};
+        }
+
+        std::string body{"["};
+        std::lock_guard<std::mutex> lk{mutex_};
+        for (const auto &key : split_keys_(req.params["keys"]))
+        {
+            if (body.size() > 1) body += ",";
+            auto it = store_.find(key);
+            body += (it == store_.end()) ? "null" : it->second;
+        }
+        body += "]";
+        return {200, "application/json", body};
+    });
+
+    server.handle_request(luna::request_method::PUT, "/persist/mset", [=](auto req) -> luna::response
+    {
+        ++msets_;
+        behaviour.delay();
+        if (behaviour.fail())
+        {
+            ++failed_;
+            return {500, "application/json", R"({"error":"internal"})"};
+        }
+
+        Json::Value batch;
+        Json::Reader reader;
+        if (!reader.parse(req.body, batch) || !batch.isArray())
+        {
+            return {400, "application/json", R"({"error":"expected an array of key/value pairs"})"};
+        }
+
+        Json::FastWriter writer;
+        std::lock_guard<std::mutex> lk{mutex_};
+        for (const auto &kv : batch)
+        {
+            auto value = writer.write(kv["value"]);
+            value.pop_back(); // FastWriter ends everything with a newline
+            store_[kv["key"].asString()] = value;
+        }
+        return {200, "application/json", "{}"};
+    });
+
+    server.handle_request(luna::request_method::DELETE, "/persist/mdel", [=](auto req) -> luna::response
+    {
+        ++mdels_;
+        behaviour.delay();
+        if (behaviour.fail())
+        {
+            ++failed_;
+            return {500, "application/json", R"({"error":"internal"})"};
+        }
+
+        std::lock_guard<std::mutex> lk{mutex_};
+        for (const auto &key : split_keys_(req.params["keys"]))
+        {
+            store_.erase(key);
+        }
+        return {200, "application/json", "{}"};
+    });
+
+    server.handle_request(luna::request_method::GET, "/stats", [](auto req) -> luna::response
+    {
+        return {200, "application/json",
+                R"({"kv_get":)" + std::to_string(kv_gets_) + R"(,"kv_put":)" + std::to_string(kv_puts_) +
+                R"(,"kv_delete":)" + std::to_string(kv_deletes_) + R"(,"mget":)" + std::to_string(mgets_) +
+                R"(,"mset":)" + std::to_string(msets_) + R"(,"mdel":)" + std::to_string(mdels_) +
+                R"(,"failed":)" + std::to_string(failed_) + "}"};
+    });
+
+    std::cout << "Persist stand-in listening on port " << port << std::endl;
+    idle_forever();
+}
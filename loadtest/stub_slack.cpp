@@ -0,0 +1,98 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+// A stand-in for the parts of Slack's Web API that waldorfbot calls: users.list, channels.info and
+// chat.postMessage. Every team has Statler installed and in every channel. On top of the latency and errors every
+// stand-in can be given, RATE_LIMIT_PERCENT of calls are answered with a 429 and a Retry-After of
+// RETRY_AFTER_SECONDS. GET /stats reports what's been posted, for the replayer.
+
+#include <atomic>
+#include <iostream>
+#include <luna/luna.h>
+#include "common.h"
+
+static std::atomic<uint64_t> posted_{0};
+static std::atomic<uint64_t> rate_limited_{0};
+static std::atomic<uint64_t> failed_{0};
+static std::atomic<uint64_t> lookups_{0};
+
+int main(int argc, char *argv[])
+{
+    uint16_t port = env_or("PORT", 9001L);
+    service_behaviour behaviour;
+    auto rate_limit_percent = env_or("RATE_LIMIT_PERCENT", 0L);
+    auto retry_after = std::to_string(env_or("RETRY_AFTER_SECONDS", 1L));
+
+    luna::server server{luna::server::port{port}, luna::server::thread_pool_size{64}};
+    if (!server)
+    {
+        std::cerr << "Failed to stand up the Slack stand-in on port " << port << std::endl;
+        return -1;
+    }
+
+    // Whatever the call, this decides whether it gets through.
+    auto gate = [=](const std::string &method, luna::response &failure) -> bool
+    {
+        behaviour.delay();
+        if (chance(rate_limit_percent))
+        {
+            ++rate_limited_;
+            failure = {429, "application/json", R"({"ok":false,"error":"ratelimited"})"};
+            failure.headers["Retry-After"] = retry_after;
+            return false;
+        }
+        if (behaviour.fail())
+        {
+            ++failed_;
+            failure = {500, "application/json", R"({"ok":false,"error":"internal_error"})"};
+            return false;
+        }
+        return true;
+    };
+
+    server.handle_request(luna::request_method::GET, "/api/users.list", [=](auto req) -> luna::response
+    {
+        luna::response failure{500};
+        if (!gate("users.list", failure)) return failure;
+        ++lookups_;
+
+        return {200, "application/json",
+                R"({"ok":true,"members":[)"
+                        R"({"id":"U0JFJ3K8A","name":"waldorf","is_bot":true,"profile":{"bot_id":"B0JFJ3K89"}},)"
+                        R"({"id":"U0FL18L8J","name":"statler","is_bot":true,)"
+                        R"("profile":{"api_app_id":"A0FL18L8H","bot_id":"B0FL18L8H"}},)"
+                        R"({"id":"U2147483697","name":"cal","is_bot":false,"profile":{}}],)"
+                        R"("response_metadata":{"next_cursor":""}})"};
+    });
+
+    server.handle_request(luna::request_method::GET, "/api/channels.info", [=](auto req) -> luna::response
+    {
+        luna::response failure{500};
+        if (!gate("channels.info", failure)) return failure;
+        ++lookups_;
+
+        return {200, "application/json",
+                R"({"ok":true,"channel":{"id":")" + req.params["channel"] +
+                R"(","members":["U0JFJ3K8A","U0FL18L8J","U2147483697"]}})"};
+    });
+
+    server.handle_request(luna::request_method::POST, "/api/chat.postMessage", [=](auto req) -> luna::response
+    {
+        luna::response failure{500};
+        if (!gate("chat.postMessage", failure)) return failure;
+        ++posted_;
+
+        return {200, "application/json", R"({"ok":true,"channel":")" + req.params["channel"] + R"(","ts":"1.0"})"};
+    });
+
+    server.handle_request(luna::request_method::GET, "/stats", [](auto req) -> luna::response
+    {
+        return {200, "application/json",
+                R"({"posted":)" + std::to_string(posted_) + R"(,"rate_limited":)" + std::to_string(rate_limited_) +
+                R"(,"failed":)" + std::to_string(failed_) + R"(,"lookups":)" + std::to_string(lookups_) + "}"};
+    });
+
+    std::cout << "Slack stand-in listening on port " << port << std::endl;
+    idle_forever();
+}
@@ -0,0 +1,386 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#include "log_store.h"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <libgen.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "logging.h"
+
+// Each record is: crc32 (4) | op (1) | key length (4) | value length (4) | key | value
+// The CRC covers everything after itself.
+static constexpr size_t header_size_ = 13;
+static constexpr size_t min_compaction_bytes_ = 1024 * 1024;
+
+static uint32_t crc32_(const char *data, size_t len, uint32_t crc = 0)
+{
+    static const auto table = []
+    {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k)
+            {
+                c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    crc = ~crc;
+    for (size_t i = 0; i < len; ++i)
+    {
+        crc = table[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static bool write_all_(int fd, const char *data, size_t len)
+{
+    while (len > 0)
+    {
+        auto n = ::write(fd, data, len);
+        if (n < 0)
+        {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+log_store::log_store(const std::string &path, std::chrono::milliseconds sync_interval) :
+        path_{path},
+        sync_interval_{sync_interval},
+        fd_{-1},
+        file_bytes_{0},
+        compacted_bytes_{0},
+        dirty_{false},
+        stopping_{false}
+{
+    auto start = std::chrono::steady_clock::now();
+    recover_();
+
+    fd_ = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ < 0)
+    {
+        LOG(ERROR) << "log_store: can't open " << path_ << ": " << std::strerror(errno);
+        return;
+    }
+
+    compacted_bytes_ = file_bytes_;
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    LOG(INFO) << "log_store: recovered " << index_.size() << " keys (" << file_bytes_ << " bytes) from " << path_
+              << " in " << elapsed.count() << "ms";
+
+    background_ = std::thread{&log_store::run_, this};
+}
+
+log_store::~log_store()
+{
+    {
+        std::lock_guard<std::mutex> lk{run_mutex_};
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (background_.joinable())
+    {
+        background_.join();
+    }
+
+    sync();
+
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+    }
+}
+
+bool log_store::set(string_view key, string_view value)
+{
+    return append_(op_set, key, value);
+}
+
+bool log_store::erase(string_view key)
+{
+    return append_(op_erase, key, {});
+}
+
+bool log_store::append_(op operation, string_view key, string_view value)
+{
+    std::lock_guard<std::mutex> lk{file_mutex_};
+    if (fd_ < 0)
+    {
+        return false;
+    }
+
+    size_t written;
+    if (!write_record_(fd_, operation, key, value, written))
+    {
+        LOG(ERROR) << "log_store: write to " << path_ << " failed: " << std::strerror(errno);
+
+        // Cut off whatever part of the record made it out. Left in the middle of the log, it would end the replay
+        // on the next start, and take every good record after it along with it.
+        if (::ftruncate(fd_, file_bytes_) != 0)
+        {
+            LOG(ERROR) << "log_store: can't cut a torn record off " << path_ << ", refusing any more writes: "
+                       << std::strerror(errno);
+            ::fdatasync(fd_); // for the good records before it
+            ::close(fd_);
+            fd_ = -1;
+        }
+        return false;
+    }
+    file_bytes_ += written;
+    dirty_.store(true, std::memory_order_release);
+
+    // the index is updated under the file lock, so it always agrees with the order of the log
+    if (operation == op_set)
+    {
+        index_.set(key, value);
+    }
+    else
+    {
+        index_.erase(key);
+    }
+
+    if (file_bytes_ > std::max(2 * compacted_bytes_, min_compaction_bytes_))
+    {
+        wake_.notify_one();
+    }
+
+    return true;
+}
+
+void log_store::encode_record_(std::string &out, op operation, string_view key, string_view value)
+{
+    auto start = out.size();
+    out.resize(start + header_size_);
+    out[start + 4] = static_cast<char>(operation);
+    uint32_t key_len = key.size(), value_len = value.size();
+    std::memcpy(&out[start + 5], &key_len, 4);
+    std::memcpy(&out[start + 9], &value_len, 4);
+    out.append(key.data(), key.size());
+    out.append(value.data(), value.size());
+
+    uint32_t crc = crc32_(&out[start + 4], out.size() - start - 4);
+    std::memcpy(&out[start], &crc, 4);
+}
+
+bool log_store::write_record_(int fd, op operation, string_view key, string_view value, size_t &written)
+{
+    std::string record;
+    encode_record_(record, operation, key, value);
+    written = record.size();
+    return write_all_(fd, record.data(), record.size());
+}
+
+void log_store::recover_()
+{
+    int fd = ::open(path_.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return; // nothing to recover
+    }
+
+    std::string log;
+    char buf[65536];
+    ssize_t n;
+    while ((n = ::read(fd, buf, sizeof(buf))) > 0 || (n < 0 && errno == EINTR))
+    {
+        if (n > 0) log.append(buf, n);
+    }
+
+    size_t pos = 0;
+    while (pos + header_size_ <= log.size())
+    {
+        uint32_t crc, key_len, value_len;
+        std::memcpy(&crc, &log[pos], 4);
+        std::memcpy(&key_len, &log[pos + 5], 4);
+        std::memcpy(&value_len, &log[pos + 9], 4);
+        auto record_size = header_size_ + static_cast<size_t>(key_len) + value_len;
+        if (pos + record_size > log.size() || crc32_(&log[pos + 4], record_size - 4) != crc)
+        {
+            break;
+        }
+
+        string_view key{&log[pos + header_size_], key_len};
+        switch (static_cast<op>(log[pos + 4]))
+        {
+            case op_set:
+                index_.set(key, {&log[pos + header_size_ + key_len], value_len});
+                break;
+            case op_erase:
+                index_.erase(key);
+                break;
+        }
+        pos += record_size;
+    }
+
+    if (pos < log.size())
+    {
+        LOG(WARNING) << "log_store: dropping " << (log.size() - pos) << " bytes of torn or corrupt log at the end of "
+                     << path_;
+        if (::ftruncate(fd, pos) != 0 || ::fsync(fd) != 0)
+        {
+            LOG(ERROR) << "log_store: can't truncate " << path_ << ": " << std::strerror(errno);
+        }
+    }
+
+    file_bytes_ = pos;
+    ::close(fd);
+}
+
+bool log_store::sync()
+{
+    if (!dirty_.exchange(false, std::memory_order_acq_rel))
+    {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lk{file_mutex_};
+    if (fd_ < 0)
+    {
+        return false; // already given up on, and already said so
+    }
+    if (::fdatasync(fd_) != 0)
+    {
+        LOG(ERROR) << "log_store: fsync of " << path_ << " failed: " << std::strerror(errno);
+        dirty_.store(true, std::memory_order_release);
+        return false;
+    }
+    return true;
+}
+
+bool log_store::compact()
+{
+    std::lock_guard<std::mutex> compact_lk{compact_mutex_};
+    auto start = std::chrono::steady_clock::now();
+
+    // Everything logged before the mark is already in the index. The snapshot may also pick up some of what's logged
+    // after it, but all of that is copied across again at the end, in order, so the last word on every key is right.
+    size_t mark;
+    {
+        std::lock_guard<std::mutex> lk{file_mutex_};
+        if (fd_ < 0)
+        {
+            return false;
+        }
+        mark = file_bytes_;
+    }
+
+    // The live keys are already all in memory, so the new log is built there too, and no stripe of the index is
+    // held for any longer than it takes to copy it.
+    std::string image;
+    index_.for_each([&](const std::string &key, const std::string &value)
+                    { encode_record_(image, op_set, key, value); });
+
+    auto tmp_path = path_ + ".compact";
+    int tmp = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (tmp < 0)
+    {
+        LOG(ERROR) << "log_store: can't open " << tmp_path << ": " << std::strerror(errno);
+        return false;
+    }
+    if (!write_all_(tmp, image.data(), image.size()) || ::fsync(tmp) != 0)
+    {
+        LOG(ERROR) << "log_store: compaction of " << path_ << " failed: " << std::strerror(errno);
+        ::close(tmp);
+        ::unlink(tmp_path.c_str());
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lk{file_mutex_};
+    auto before = file_bytes_;
+    if (fd_ < 0 || !copy_tail_(tmp, mark) || ::fdatasync(tmp) != 0 || ::rename(tmp_path.c_str(), path_.c_str()) != 0)
+    {
+        LOG(ERROR) << "log_store: compaction of " << path_ << " failed: " << std::strerror(errno);
+        ::close(tmp);
+        ::unlink(tmp_path.c_str());
+        return false;
+    }
+
+    // make the rename itself durable before anything is appended to the new file
+    std::string dir_path{path_};
+    int dir = ::open(::dirname(&dir_path[0]), O_RDONLY | O_CLOEXEC);
+    if (dir >= 0)
+    {
+        ::fsync(dir);
+        ::close(dir);
+    }
+
+    // tmp was opened for appending, and is now the log
+    ::close(fd_);
+    fd_ = tmp;
+    file_bytes_ = compacted_bytes_ = image.size() + (before - mark);
+    dirty_.store(false, std::memory_order_release);
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    LOG(INFO) << "log_store: compacted " << path_ << " from " << before << " to " << file_bytes_ << " bytes in "
+              << elapsed.count() << "ms";
+    return true;
+}
+
+bool log_store::copy_tail_(int to, size_t from)
+{
+    if (file_bytes_ == from)
+    {
+        return true;
+    }
+
+    int log = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (log < 0)
+    {
+        return false;
+    }
+
+    char buf[65536];
+    auto pos = from;
+    while (pos < file_bytes_)
+    {
+        auto n = ::pread(log, buf, std::min(sizeof(buf), file_bytes_ - pos), pos);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0 || !write_all_(to, buf, n))
+        {
+            ::close(log);
+            return false;
+        }
+        pos += n;
+    }
+    ::close(log);
+    return true;
+}
+
+void log_store::run_()
+{
+    std::unique_lock<std::mutex> lk{run_mutex_};
+    while (!stopping_)
+    {
+        wake_.wait_for(lk, sync_interval_);
+        lk.unlock();
+
+        sync();
+
+        bool needs_compaction;
+        {
+            std::lock_guard<std::mutex> file_lk{file_mutex_};
+            needs_compaction = file_bytes_ > std::max(2 * compacted_bytes_, min_compaction_bytes_);
+        }
+        if (needs_compaction)
+        {
+            compact();
+        }
+
+        lk.lock();
+    }
+}
@@ -0,0 +1,84 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#pragma once
+
+// A durable key-value store on local disk. Every set and erase is appended to a log file as a checksummed record,
+// and the current value of every key is kept in memory, so reads never touch the disk. Rather than fsync on every
+// write, a background thread syncs whatever has been appended every sync_interval. On startup the log is replayed;
+// a torn or corrupt record at the tail (from a crash mid-write) ends the replay and is cut off. Once the log has
+// grown to twice its size after the last compaction, the same background thread rewrites it with only the live keys
+// and atomically renames it into place. The rewrite happens outside the file lock, from a snapshot of the index;
+// appends carry on meanwhile, and only the records they added are copied across under the lock, just before the swap.
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "sharded_map.h"
+
+class log_store
+{
+public:
+    log_store(const std::string &path, std::chrono::milliseconds sync_interval);
+
+    ~log_store();
+
+    bool ok() const
+    { return fd_ >= 0; }
+
+    bool get(string_view key, std::string &value) const
+    { return index_.get(key, value); }
+
+    bool set(string_view key, string_view value);
+
+    bool erase(string_view key);
+
+    // Write out everything appended so far and fsync it.
+    bool sync();
+
+    bool compact();
+
+    size_t size() const
+    { return index_.size(); }
+
+private:
+    enum op : uint8_t
+    {
+        op_set = 1,
+        op_erase = 2,
+    };
+
+    bool append_(op operation, string_view key, string_view value);
+
+    bool write_record_(int fd, op operation, string_view key, string_view value, size_t &written);
+
+    static void encode_record_(std::string &out, op operation, string_view key, string_view value);
+
+    // With file_mutex_ held. Appends what was logged from offset `from` on to the compacted file.
+    bool copy_tail_(int to, size_t from);
+
+    void recover_();
+
+    void run_();
+
+    const std::string path_;
+    const std::chrono::milliseconds sync_interval_;
+
+    sharded_map index_;
+
+    std::mutex compact_mutex_; // one compaction at a time
+    std::mutex file_mutex_;    // serializes appends, syncs, and the end of a compaction
+    int fd_;
+    size_t file_bytes_;
+    size_t compacted_bytes_;
+    std::atomic<bool> dirty_;
+
+    std::mutex run_mutex_;
+    std::condition_variable wake_;
+    bool stopping_;
+    std::thread background_;
+};
@@ -9,4 +9,17 @@
 #define ELPP_THREAD_SAFE
 #define ELPP_FORCE_USE_STD_THREAD
 
-#include <easylogging++.h>
\ No newline at end of file
+#include <easylogging++.h>
+#include "async_log.h"
+
+// Levels below this (0 for DEBUG up to 4 for FATAL) are compiled out altogether: the condition below is a constant, so the
+// formatting behind it never makes it into the binary.
+#ifndef WALDORF_LOG_MIN_LEVEL
+#define WALDORF_LOG_MIN_LEVEL 0
+#endif
+
+// LOG(INFO) << ... as before, but through async_log.h rather than straight into easylogging++.
+#undef LOG
+#define LOG(LEVEL)                                                                                                    \
+    (static_cast<int>(log_severity::LEVEL) < WALDORF_LOG_MIN_LEVEL || !log_enabled(log_severity::LEVEL))                    \
+            ? (void) 0 : log_voidify{} & log_line{log_severity::LEVEL}.stream()
@@ -1,10 +1,22 @@
 #include <iostream>
 #include <thread>
-#include <condition_variable>
+#include <algorithm>
+#include <csignal>
+#include <memory>
+#include <pthread.h>
 #include <luna/luna.h>
 #include <slack/slack.h>
 #include "logging.h"
 #include "event_receiver.h"
+#include "executor.h"
+#include "slack_client_pool.h"
+#include "rate_policy.h"
+#include "slack_outbox.h"
+#include "rng.h"
+#include "metrics.h"
+#include "id_interner.h"
+#include "warm_start.h"
+#include "listener_shards.h"
 
 INITIALIZE_EASYLOGGINGPP
 
@@ -64,15 +76,203 @@ int main(int argc, char* argv[])
 //    // default logger uses default configurations
 //    el::Loggers::reconfigureLogger("default", defaultConf);
 
-    //http://www.tutorialspoint.com/cplusplus/cpp_signal_handling.htm
+    // SIGTERM and SIGINT (shut down), SIGHUP (reload the dialog) and SIGUSR1 (re-read rate settings) are waited for at
+    // the bottom of main rather than handled where they land, so that what they do can take locks and do I/O. They're
+    // blocked here, before any other thread starts, so that every thread inherits the mask and none of them gets the
+    // signal instead.
+    sigset_t handled_signals;
+    sigemptyset(&handled_signals);
+    sigaddset(&handled_signals, SIGTERM);
+    sigaddset(&handled_signals, SIGINT);
+    sigaddset(&handled_signals, SIGHUP);
+    sigaddset(&handled_signals, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &handled_signals, nullptr);
 
     // First, let's check those env variables
+    bool log_async = true;
+    if (auto log_async_str = std::getenv("LOG_ASYNC"))
+    {
+        log_async = atoi(log_async_str) != 0;
+    }
+
+    // What to do when a thread logs faster than the writer can keep up: "drop" (and count) or "block"
+    auto log_overflow_policy = log_overflow::drop;
+    if (auto log_overflow_str = std::getenv("LOG_OVERFLOW"))
+    {
+        log_overflow_policy = (std::string{log_overflow_str} == "block") ? log_overflow::block : log_overflow::drop;
+    }
+
+    if (auto log_level_str = std::getenv("LOG_LEVEL"))
+    {
+        std::string level{log_level_str};
+        if (level == "info") set_log_level(log_severity::INFO);
+        else if (level == "warning") set_log_level(log_severity::WARNING);
+        else if (level == "error") set_log_level(log_severity::ERROR);
+    }
+
     uint16_t port = 8080;
     if (auto port_str = std::getenv("PORT"))
     {
         port = atoi(port_str);
     }
 
+    // More than one process can listen on the port, each with its share of the cores
+    size_t listener_processes = 1;
+    if (auto listener_processes_str = std::getenv("LISTENER_PROCESSES"))
+    {
+        listener_processes = std::max(atoi(listener_processes_str), 1);
+    }
+
+    bool pin_cpus = false;
+    if (auto pin_cpus_str = std::getenv("PIN_CPUS"))
+    {
+        pin_cpus = atoi(pin_cpus_str) != 0;
+    }
+
+    unsigned cores = std::max<unsigned>(std::thread::hardware_concurrency() / listener_processes, 1);
+
+    size_t http_threads = std::max(cores, 2u);
+    if (auto http_threads_str = std::getenv("HTTP_THREADS"))
+    {
+        http_threads = atoi(http_threads_str);
+    }
+
+    size_t worker_threads = std::max(cores, 2u);
+    if (auto worker_threads_str = std::getenv("WORKER_THREADS"))
+    {
+        worker_threads = atoi(worker_threads_str);
+    }
+
+    size_t worker_queue_depth = 1024;
+    if (auto worker_queue_depth_str = std::getenv("WORKER_QUEUE_DEPTH"))
+    {
+        worker_queue_depth = atoi(worker_queue_depth_str);
+    }
+
+    size_t slack_connections_per_team = 4;
+    if (auto slack_connections_str = std::getenv("SLACK_CONNECTIONS_PER_TEAM"))
+    {
+        slack_connections_per_team = atoi(slack_connections_str);
+    }
+
+    std::chrono::seconds slack_connection_idle{60};
+    if (auto slack_connection_idle_str = std::getenv("SLACK_CONNECTION_IDLE_SECONDS"))
+    {
+        slack_connection_idle = std::chrono::seconds{atoi(slack_connection_idle_str)};
+    }
+
+    // Only ever changed to point us at a stand-in, for load testing
+    if (auto slack_api_url_str = std::getenv("SLACK_API_URL"))
+    {
+        set_slack_api_url(slack_api_url_str);
+    }
+
+    // chat.postMessage allows about one message a second per channel, with short bursts over that
+    slack_outbox::limits slack_limits{1.0, 3, 10.0, 20, 10000};
+    if (auto slack_channel_rate_str = std::getenv("SLACK_CHANNEL_RATE"))
+    {
+        slack_limits.channel_per_second = atof(slack_channel_rate_str);
+    }
+    if (auto slack_channel_burst_str = std::getenv("SLACK_CHANNEL_BURST"))
+    {
+        slack_limits.channel_burst = atoi(slack_channel_burst_str);
+    }
+    if (auto slack_team_rate_str = std::getenv("SLACK_TEAM_RATE"))
+    {
+        slack_limits.team_per_second = atof(slack_team_rate_str);
+    }
+    if (auto slack_team_burst_str = std::getenv("SLACK_TEAM_BURST"))
+    {
+        slack_limits.team_burst = atoi(slack_team_burst_str);
+    }
+    if (auto slack_delayed_max_str = std::getenv("SLACK_DELAYED_MAX"))
+    {
+        slack_limits.max_delayed = atoi(slack_delayed_max_str);
+    }
+
+    size_t team_cache_size = 10000;
+    if (auto team_cache_size_str = std::getenv("TEAM_CACHE_SIZE"))
+    {
+        team_cache_size = atoi(team_cache_size_str);
+    }
+
+    std::chrono::seconds team_cache_ttl{600};
+    if (auto team_cache_ttl_str = std::getenv("TEAM_CACHE_TTL_SECONDS"))
+    {
+        team_cache_ttl = std::chrono::seconds{atoi(team_cache_ttl_str)};
+    }
+
+    std::chrono::seconds team_cache_absent_ttl{300};
+    if (auto team_cache_absent_ttl_str = std::getenv("TEAM_CACHE_ABSENT_TTL_SECONDS"))
+    {
+        team_cache_absent_ttl = std::chrono::seconds{atoi(team_cache_absent_ttl_str)};
+    }
+
+    size_t channel_cache_size = 100000;
+    if (auto channel_cache_size_str = std::getenv("CHANNEL_CACHE_SIZE"))
+    {
+        channel_cache_size = atoi(channel_cache_size_str);
+    }
+
+    // Join and leave events keep member lists current; this is in case some of them never reach us
+    std::chrono::seconds channel_cache_ttl{3600};
+    if (auto channel_cache_ttl_str = std::getenv("CHANNEL_CACHE_TTL_SECONDS"))
+    {
+        channel_cache_ttl = std::chrono::seconds{atoi(channel_cache_ttl_str)};
+    }
+
+    uint8_t heckle_percent = 5;
+    if (auto heckle_percent_str = std::getenv("HECKLE_PERCENT"))
+    {
+        heckle_percent = std::min(std::max(atoi(heckle_percent_str), 0), 100);
+    }
+
+    // For load tests: the same seed and the same events make the same decisions
+    if (auto rng_seed_str = std::getenv("RNG_SEED"))
+    {
+        set_rng_seed(std::strtoull(rng_seed_str, nullptr, 10));
+        LOG(INFO) << "Using deterministic random seed " << rng_seed_str;
+    }
+
+    std::string admin_token;
+    if (auto admin_token_raw = std::getenv("ADMIN_TOKEN"))
+    {
+        admin_token = {admin_token_raw};
+    }
+
+    // Slack retries for a few minutes when we're slow to answer
+    std::chrono::seconds event_dedup_window{600};
+    if (auto event_dedup_window_str = std::getenv("EVENT_DEDUP_WINDOW_SECONDS"))
+    {
+        event_dedup_window = std::chrono::seconds{atoi(event_dedup_window_str)};
+    }
+
+    size_t event_dedup_max = 100000;
+    if (auto event_dedup_max_str = std::getenv("EVENT_DEDUP_MAX"))
+    {
+        event_dedup_max = atoi(event_dedup_max_str);
+    }
+
+    // Where our lines come from; without a file, the ones built in
+    std::string dialog_path;
+    if (auto dialog_path_raw = std::getenv("DIALOG_PATH"))
+    {
+        dialog_path = {dialog_path_raw};
+    }
+
+    // Where hot team and channel state is kept across restarts; without one, every restart starts cold
+    std::string snapshot_path;
+    if (auto snapshot_path_raw = std::getenv("SNAPSHOT_PATH"))
+    {
+        snapshot_path = {snapshot_path_raw};
+    }
+
+    std::chrono::seconds warm_start_timeout{30};
+    if (auto warm_start_timeout_str = std::getenv("WARM_START_TIMEOUT_SECONDS"))
+    {
+        warm_start_timeout = std::chrono::seconds{atoi(warm_start_timeout_str)};
+    }
+
     // Create a memory store
     auto beepboop_token_raw = std::getenv("BEEPBOOP_TOKEN");
     auto beepboop_persist_url_raw = std::getenv("BEEPBOOP_PERSIST_URL");
@@ -83,33 +283,285 @@ int main(int argc, char* argv[])
         beepboop_token = {beepboop_token_raw};
         beepboop_persist_url = {beepboop_persist_url_raw};
     }
-    beep_boop_persist store{beepboop_persist_url, beepboop_token};
+    std::string persist_log_path;
+    if (auto persist_log_path_raw = std::getenv("PERSIST_LOG_PATH"))
+    {
+        persist_log_path = {persist_log_path_raw};
+    }
+
+    std::chrono::milliseconds persist_log_sync{50};
+    if (auto persist_log_sync_str = std::getenv("PERSIST_LOG_SYNC_MS"))
+    {
+        persist_log_sync = std::chrono::milliseconds{atoi(persist_log_sync_str)};
+    }
+
+    size_t persist_io_threads = 4;
+    if (auto persist_io_threads_str = std::getenv("PERSIST_IO_THREADS"))
+    {
+        persist_io_threads = atoi(persist_io_threads_str);
+    }
+
+    // The other listener processes are forked off now, while this is still the only thread
+    auto shards = fork_shards(listener_processes);
+    if (pin_cpus)
+    {
+        pin_shard(shards);
+    }
+    if (log_async)
+    {
+        start_async_logging(log_overflow_policy);
+    }
+    if (shards.index > 0)
+    {
+        // each shard keeps its own local files
+        auto suffix = "." + std::to_string(shards.index);
+        if (!persist_log_path.empty()) persist_log_path += suffix;
+        if (!snapshot_path.empty()) snapshot_path += suffix;
+    }
+
+    beep_boop_persist store{beepboop_persist_url,
+                            beepboop_token,
+                            persist_log_path,
+                            persist_log_sync,
+                            persist_io_threads};
+
+    if (auto write_behind_ms_str = std::getenv("PERSIST_WRITE_BEHIND_MS"))
+    {
+        size_t write_behind_batch = 100;
+        if (auto write_behind_batch_str = std::getenv("PERSIST_WRITE_BEHIND_BATCH"))
+        {
+            write_behind_batch = atoi(write_behind_batch_str);
+        }
+        store.enable_write_behind(write_behind_batch, std::chrono::milliseconds{atoi(write_behind_ms_str)});
+    }
+
+    executor workers{worker_threads, worker_queue_depth};
+    LOG(INFO) << "Handling events on " << workers.workers() << " workers, queue depth " << workers.max_queued();
+
+    slack_client_pool clients{slack_connections_per_team, slack_connection_idle};
+
+    slack_outbox outbox{clients, workers, slack_limits};
+
+    team_info_cache team_cache{team_cache_size, team_cache_ttl, team_cache_absent_ttl};
+
+    channel_membership channels{channel_cache_size, channel_cache_ttl};
+
+    rate_policy rates{store, heckle_percent};
+
+    // per listener shard, so with more than one a redelivery can still be handled twice (see listener_shards.h)
+    event_dedup seen_events{event_dedup_window, event_dedup_max};
+
+    auto reload_dialog = [&](dialog &d) -> bool
+    {
+        std::string error;
+        if (!load_dialog(dialog_path, d, error))
+        {
+            LOG(ERROR) << "Couldn't load dialog from " << dialog_path << ": " << error;
+            return false;
+        }
+        LOG(INFO) << "Loaded " << d.size() << " lines and " << d.heckles().size() << " heckles from " << dialog_path;
+        return true;
+    };
+
+    dialog initial_dialog;
+    if (dialog_path.empty() || !reload_dialog(initial_dialog))
+    {
+        initial_dialog = default_dialog();
+    }
+    dialog_source dialogs{std::move(initial_dialog)};
+
+    // Warm the caches back up before we start listening, so that the first message from every team after a deploy
+    // doesn't go to the store (or worse, users.list) all at once.
+    if (!snapshot_path.empty())
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::string> known_teams;
+        load_snapshot(snapshot_path, team_cache, channels, known_teams);
+        auto loaded = std::chrono::steady_clock::now();
+        LOG(INFO) << "Snapshot loaded in "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(loaded - start).count() << "ms";
+
+        auto refreshed = refresh_teams(store, team_cache, known_teams, loaded + warm_start_timeout);
+        LOG(INFO) << "Warmed up in "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start)
+                          .count()
+                  << "ms, " << refreshed << " of " << known_teams.size() << " teams refreshed from the store";
+    }
+
+    luna::set_logger(luna_logger);
+
+    slack::set_logger(slack_logger);
 
     // Now, let's stand up a webserver
     // Let's not worry about TLS for now, as we'll stand up behind ngrok for now
-    luna::server server{luna::server::port{port}};
+    // Held by pointer so that it can be taken down first on shutdown, before anything its routes use.
+    std::unique_ptr<luna::server> server;
+    if (shards.count > 1)
+    {
+        auto listen_fd = reuseport_socket(port);
+        if (listen_fd >= 0)
+        {
+            server.reset(new luna::server{luna::server::listen_socket{listen_fd},
+                                          luna::server::thread_pool_size{static_cast<unsigned>(http_threads)}});
+        }
+    }
+    else
+    {
+        server.reset(new luna::server{luna::server::port{port},
+                                      luna::server::thread_pool_size{static_cast<unsigned>(http_threads)}});
+    }
 
-    if (!server)
+    if (!server || !*server)
     {
         LOG(FATAL) << "Failed to stand up webserver!";
         return -1;
     }
 
-    luna::set_logger(luna_logger);
+    LOG(INFO) << "Server started on port " << std::to_string(shards.count > 1 ? port : server->get_port())
+              << " with " << http_threads << " HTTP threads, listener shard " << shards.index << " of " << shards.count;
 
-    slack::set_logger(slack_logger);
+    event_receiver receiver{store, workers, clients, team_cache, channels, rates, outbox, seen_events, dialogs, ""}; //use empty string because beep boop is doing the checking for us.
+    receiver.add_routes(*server);
+
+    // Everything else we'd like to see in /metrics is already being counted somewhere, so it's just read out
+    auto &registry = metrics();
+    registry.callback("waldorf_events_total", "Events received", "counter", [&]
+    { return receiver.events(); });
+    registry.callback("waldorf_events_filtered_total", "Events dropped by the prefilter", "counter", [&]
+    { return receiver.filtered_events(); });
+    registry.callback("waldorf_events_duplicate_total", "Redelivered events ignored", "counter", [&]
+    { return seen_events.duplicates(); });
+    registry.callback("waldorf_dialog_version", "How many times the dialog has been reloaded", "gauge", [&]
+    { return dialogs.version(); });
+    registry.callback("waldorf_log_lines_dropped_total", "Log lines dropped because a log buffer was full", "counter", []
+    { return log_lines_dropped(); });
+    registry.callback("waldorf_worker_queue_depth", "Events waiting for a worker", "gauge", [&]
+    { return workers.queued(); });
+    registry.callback("waldorf_persist_pending_writes", "Writes waiting to be flushed to the store", "gauge", [&]
+    { return store.pending_writes(); });
+    registry.callback("waldorf_slack_delayed_queue_depth", "Messages waiting for Slack rate limit budget", "gauge", [&]
+    { return outbox.queued(); });
+    registry.callback("waldorf_interned_ids", "Distinct Slack IDs held, which are never let go", "gauge", []
+    { return ids().size(); });
+    registry.callback("waldorf_interned_bytes", "Memory held by interned Slack IDs", "gauge", []
+    { return ids().bytes(); });
+    registry.callback("waldorf_slack_idle_connections", "Pooled Slack connections not in use", "gauge", [&]
+    { return clients.idle_connections(); });
+    registry.callback("waldorf_slack_messages_total", "Messages posted to Slack", "counter", [&]
+    { return outbox.sent(); }, R"(result="sent")");
+    registry.callback("waldorf_slack_messages_total", "Messages posted to Slack", "counter", [&]
+    { return outbox.dropped(); }, R"(result="dropped")");
+    registry.callback("waldorf_slack_messages_delayed_total", "Messages held back for rate limit budget", "counter", [&]
+    { return outbox.delayed(); });
+    registry.callback("waldorf_slack_rate_limited_total", "429 responses from Slack", "counter", [&]
+    { return outbox.rate_limited(); });
+    registry.callback("waldorf_team_cache_requests_total", "Team cache lookups", "counter", [&]
+    { return team_cache.hits(); }, R"(result="hit")");
+    registry.callback("waldorf_team_cache_requests_total", "Team cache lookups", "counter", [&]
+    { return team_cache.absent_hits(); }, R"(result="absent")");
+    registry.callback("waldorf_team_cache_requests_total", "Team cache lookups", "counter", [&]
+    { return team_cache.misses(); }, R"(result="miss")");
 
-    LOG(INFO) << "Server started on port " << std::to_string(server.get_port());
+    server->handle_request(luna::request_method::GET, "/metrics", [&](auto req) -> luna::response
+    {
+        return {200, "text/plain; version=0.0.4", registry.render()};
+    });
 
-    event_receiver receiver{server, store, ""}; //use empty string because beep boop is doing the checking for us.
+    // Admin routes are only there when there's a token to guard them with
+    if (!admin_token.empty())
+    {
+        // PUT /admin/rate?team=T123&percent=10 for a whole team, or add channel=C123 for just that channel. A percent
+        // over 100 goes back to the default. With more than one listener shard, the settings have to be in a store
+        // they all share, and the others are told to read them again.
+        server->handle_request(luna::request_method::PUT, "/admin/rate", [&](auto req) -> luna::response
+        {
+            if (req.headers["Authorization"] != "Bearer " + admin_token)
+            {
+                return {401};
+            }
+            if (shards.count > 1 && store.is_local())
+            {
+                return {409, "rate settings need a shared store (BEEPBOOP_PERSIST_URL) with more than one listener"};
+            }
+
+            auto team = req.params["team"];
+            auto percent = req.params["percent"];
+            if (team.empty() || percent.empty() || percent.find_first_not_of("0123456789") != std::string::npos)
+            {
+                return {400, "team and percent are required"};
+            }
+
+            auto channel = req.params["channel"];
+            unsigned value = std::strtoul(percent.c_str(), nullptr, 10);
+            bool ok = channel.empty() ? rates.set_team(team, value) : rates.set_channel(team, channel, value);
+            if (ok && shards.count > 1)
+            {
+                ok = store.flush(); // so that it's there when they look
+                signal_all_shards(shards, SIGUSR1);
+            }
+            return ok ? luna::response{200} : luna::response{500};
+        });
+
+        // POST /admin/dialog reads DIALOG_PATH again. With one shard that's done here; with more, the file is only
+        // checked here, and every shard (this one included) reloads it from the SIGHUP that goes round, so each
+        // replaces its dialog exactly once.
+        server->handle_request(luna::request_method::POST, "/admin/dialog", [&](auto req) -> luna::response
+        {
+            if (req.headers["Authorization"] != "Bearer " + admin_token)
+            {
+                return {401};
+            }
+            if (dialog_path.empty())
+            {
+                return {409, "no DIALOG_PATH to reload from"};
+            }
+
+            dialog d;
+            if (!reload_dialog(d))
+            {
+                return {422, "couldn't load " + dialog_path + ", see the log"};
+            }
+            if (shards.count > 1)
+            {
+                signal_all_shards(shards, SIGHUP);
+                return {202};
+            }
+            dialogs.replace(std::move(d));
+            return {200};
+        });
+    }
 
     //IDLE UNTIL DEAD basically just stop this thread in its tracks
-    std::mutex m;
-    std::condition_variable cv;
+    int caught = 0;
+    while (sigwait(&handled_signals, &caught) == 0 && (caught == SIGHUP || caught == SIGUSR1))
+    {
+        signal_shards(shards, caught);
+        if (caught == SIGUSR1)
+        {
+            rates.forget();
+            continue;
+        }
+        dialog d;
+        if (!dialog_path.empty() && reload_dialog(d))
+        {
+            dialogs.replace(std::move(d));
+        }
+    }
+    LOG(INFO) << "Caught signal " << caught << ", shutting down";
+    signal_shards(shards, caught);
+
+    // Stop taking requests (this waits for the ones in progress), finish the work they left on the queue, get every
+    // write out to the store, and only then write down what we know for next time.
+    server.reset();
+    workers.shutdown();
+    store.drain();
+    if (!snapshot_path.empty())
     {
-        std::unique_lock<std::mutex> lk(m);
-        cv.wait(lk, []{return false;});
+        save_snapshot(snapshot_path, team_cache, channels);
     }
 
+    wait_for_shards(shards);
+    LOG(INFO) << "Shut down cleanly";
+    stop_async_logging();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,189 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#include "metrics.h"
+#include <sstream>
+
+constexpr size_t metric_histogram::buckets;
+
+const std::chrono::nanoseconds metric_histogram::bounds[metric_histogram::buckets] = {
+        std::chrono::microseconds{100},
+        std::chrono::microseconds{250},
+        std::chrono::microseconds{500},
+        std::chrono::milliseconds{1},
+        std::chrono::microseconds{2500},
+        std::chrono::milliseconds{5},
+        std::chrono::milliseconds{10},
+        std::chrono::milliseconds{25},
+        std::chrono::milliseconds{50},
+        std::chrono::milliseconds{100},
+        std::chrono::milliseconds{250},
+        std::chrono::milliseconds{500},
+        std::chrono::seconds{1},
+        std::chrono::milliseconds{2500},
+        std::chrono::seconds{5},
+        std::chrono::seconds{10},
+};
+
+size_t metrics_detail::cell()
+{
+    static std::atomic<size_t> next{0};
+    static thread_local size_t mine = next.fetch_add(1, std::memory_order_relaxed) % cells;
+    return mine;
+}
+
+uint64_t metric_counter::value() const
+{
+    uint64_t total = 0;
+    for (const auto &c : cells_)
+    {
+        total += c.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void metric_histogram::observe(std::chrono::nanoseconds elapsed)
+{
+    size_t bucket = 0;
+    while (bucket < buckets && elapsed > bounds[bucket])
+    {
+        ++bucket;
+    }
+
+    auto &c = cells_[metrics_detail::cell()];
+    c.counts[bucket].fetch_add(1, std::memory_order_relaxed);
+    c.sum_ns.fetch_add(elapsed.count(), std::memory_order_relaxed);
+}
+
+metric_histogram::snapshot metric_histogram::read() const
+{
+    snapshot s{};
+    uint64_t sum_ns = 0;
+    for (const auto &c : cells_)
+    {
+        for (size_t i = 0; i <= buckets; ++i)
+        {
+            auto n = c.counts[i].load(std::memory_order_relaxed);
+            s.counts[i] += n;
+            s.count += n;
+        }
+        sum_ns += c.sum_ns.load(std::memory_order_relaxed);
+    }
+    s.sum_seconds = sum_ns / 1e9;
+    return s;
+}
+
+metrics_registry::series &metrics_registry::add_(const std::string &name,
+                                                 const std::string &help,
+                                                 const std::string &type,
+                                                 const std::string &labels)
+{
+    auto &f = families_[name];
+    f.help = help;
+    f.type = type;
+    for (auto &s : f.all)
+    {
+        if (s.labels == labels)
+        {
+            return s; // registering the same thing twice gets you the same thing
+        }
+    }
+    f.all.push_back({labels, nullptr, nullptr, nullptr});
+    return f.all.back();
+}
+
+metric_counter &metrics_registry::counter(const std::string &name, const std::string &help, const std::string &labels)
+{
+    std::lock_guard<std::mutex> lk{mutex_};
+    auto &s = add_(name, help, "counter", labels);
+    if (!s.counter)
+    {
+        s.counter.reset(new metric_counter());
+    }
+    return *s.counter;
+}
+
+metric_histogram &metrics_registry::histogram(const std::string &name,
+                                              const std::string &help,
+                                              const std::string &labels)
+{
+    std::lock_guard<std::mutex> lk{mutex_};
+    auto &s = add_(name, help, "histogram", labels);
+    if (!s.histogram)
+    {
+        s.histogram.reset(new metric_histogram());
+    }
+    return *s.histogram;
+}
+
+void metrics_registry::callback(const std::string &name,
+                                const std::string &help,
+                                const std::string &type,
+                                std::function<double()> read,
+                                const std::string &labels)
+{
+    std::lock_guard<std::mutex> lk{mutex_};
+    add_(name, help, type, labels).read = std::move(read);
+}
+
+static std::string seconds_(std::chrono::nanoseconds bound)
+{
+    std::ostringstream out;
+    out << std::chrono::duration<double>{bound}.count();
+    return out.str();
+}
+
+static std::string braces_(const std::string &labels, const std::string &extra = "")
+{
+    if (labels.empty() && extra.empty())
+    {
+        return "";
+    }
+    return "{" + labels + ((labels.empty() || extra.empty()) ? "" : ",") + extra + "}";
+}
+
+std::string metrics_registry::render() const
+{
+    std::ostringstream out;
+    out.precision(15);
+    std::lock_guard<std::mutex> lk{mutex_};
+    for (const auto &f : families_)
+    {
+        const auto &name = f.first;
+        out << "# HELP " << name << " " << f.second.help << "\n";
+        out << "# TYPE " << name << " " << f.second.type << "\n";
+        for (const auto &s : f.second.all)
+        {
+            if (s.counter)
+            {
+                out << name << braces_(s.labels) << " " << s.counter->value() << "\n";
+            }
+            else if (s.histogram)
+            {
+                auto snap = s.histogram->read();
+                uint64_t cumulative = 0;
+                for (size_t i = 0; i < metric_histogram::buckets; ++i)
+                {
+                    cumulative += snap.counts[i];
+                    auto le = "le=\"" + seconds_(metric_histogram::bounds[i]) + "\"";
+                    out << name << "_bucket" << braces_(s.labels, le) << " " << cumulative << "\n";
+                }
+                out << name << "_bucket" << braces_(s.labels, "le=\"+Inf\"") << " " << snap.count << "\n";
+                out << name << "_sum" << braces_(s.labels) << " " << snap.sum_seconds << "\n";
+                out << name << "_count" << braces_(s.labels) << " " << snap.count << "\n";
+            }
+            else if (s.read)
+            {
+                out << name << braces_(s.labels) << " " << s.read() << "\n";
+            }
+        }
+    }
+    return out.str();
+}
+
+metrics_registry &metrics()
+{
+    static metrics_registry registry;
+    return registry;
+}
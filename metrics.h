@@ -0,0 +1,135 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#pragma once
+
+// Counters and latency histograms, served in Prometheus' text format. Recording is meant to be cheap enough for the
+// hot path: every metric is split into a few cells, each thread always writes to the same one with a relaxed atomic
+// add, and the cells are only summed up when somebody scrapes /metrics. Metrics are registered once (typically
+// into a function-local static at the call site) and live for the rest of the process. Numbers that something
+// else already keeps, like queue depths, can be registered as callbacks that are read at scrape time.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace metrics_detail
+{
+constexpr size_t cells = 8;
+constexpr size_t cache_line = 64;
+
+// Which cell this thread writes to.
+size_t cell();
+}
+
+class metric_counter
+{
+public:
+    void add(uint64_t n = 1)
+    { cells_[metrics_detail::cell()].value.fetch_add(n, std::memory_order_relaxed); }
+
+    uint64_t value() const;
+
+private:
+    struct cell
+    {
+        std::atomic<uint64_t> value{0};
+        char padding[metrics_detail::cache_line - sizeof(std::atomic<uint64_t>)];
+    };
+
+    cell cells_[metrics_detail::cells];
+};
+
+class metric_histogram
+{
+public:
+    // Upper bounds, in seconds, from 100µs to 10s.
+    static constexpr size_t buckets = 16;
+    static const std::chrono::nanoseconds bounds[buckets];
+
+    void observe(std::chrono::nanoseconds elapsed);
+
+    struct snapshot
+    {
+        uint64_t counts[buckets + 1]; // not cumulative; the last is everything over the top bound
+        uint64_t count;
+        double sum_seconds;
+    };
+
+    snapshot read() const;
+
+private:
+    struct cell
+    {
+        std::atomic<uint64_t> counts[buckets + 1];
+        std::atomic<uint64_t> sum_ns;
+        char padding[metrics_detail::cache_line];
+    };
+
+    cell cells_[metrics_detail::cells] = {};
+};
+
+// Times a scope into a histogram.
+class scoped_timer
+{
+public:
+    explicit scoped_timer(metric_histogram &histogram) :
+            histogram_{histogram}, start_{std::chrono::steady_clock::now()}
+    {}
+
+    ~scoped_timer()
+    { histogram_.observe(std::chrono::steady_clock::now() - start_); }
+
+private:
+    metric_histogram &histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+class metrics_registry
+{
+public:
+    // labels are written as Prometheus has them, e.g. R"(op="get")", or left empty.
+    metric_counter &counter(const std::string &name, const std::string &help, const std::string &labels = "");
+
+    metric_histogram &histogram(const std::string &name, const std::string &help, const std::string &labels = "");
+
+    // Read when scraped. type is "counter" or "gauge".
+    void callback(const std::string &name,
+                  const std::string &help,
+                  const std::string &type,
+                  std::function<double()> read,
+                  const std::string &labels = "");
+
+    std::string render() const;
+
+private:
+    struct series
+    {
+        std::string labels;
+        std::unique_ptr<metric_counter> counter;
+        std::unique_ptr<metric_histogram> histogram;
+        std::function<double()> read;
+    };
+
+    struct family
+    {
+        std::string help;
+        std::string type;
+        std::vector<series> all;
+    };
+
+    series &add_(const std::string &name, const std::string &help, const std::string &type, const std::string &labels);
+
+    mutable std::mutex mutex_;
+    std::map<std::string, family> families_;
+};
+
+// The process's metrics.
+metrics_registry &metrics();
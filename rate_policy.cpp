@@ -0,0 +1,203 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#include "rate_policy.h"
+#include <algorithm>
+#include <cstdlib>
+#include "logging.h"
+
+constexpr int rate_policy::unset_;
+constexpr std::chrono::minutes rate_policy::ttl_;
+constexpr std::chrono::minutes rate_policy::missing_ttl_;
+
+static std::string key_(const std::string &team_id)
+{
+    return "rate_policy." + team_id;
+}
+
+rate_policy::rate_policy(beep_boop_persist &store, uint8_t default_percent) :
+        store_{store}, default_percent_{std::min<uint8_t>(default_percent, 100)}
+{}
+
+// {"percent":20,"channels":{"C0JFHT99N":0}}, where either may be missing
+bool rate_policy::from_json_(string_view json, policy &p)
+{
+    json_scanner scanner{json};
+    if (!scanner.enter_object())
+    {
+        return false;
+    }
+
+    string_view key;
+    while (scanner.next_key(key))
+    {
+        if (key == "percent" && scanner.peek() != 'n')
+        {
+            string_view number;
+            scanner.read_raw_value(number);
+            p.team_percent = std::min(std::atoi(number.to_string().c_str()), 100);
+        }
+        else if (key == "channels" && scanner.peek() == '{')
+        {
+            scanner.enter_object();
+            string_view channel, number;
+            while (scanner.next_key(channel) && scanner.read_raw_value(number))
+            {
+                p.channels[ids().intern(channel)] = std::min(std::atoi(number.to_string().c_str()), 100);
+            }
+        }
+        else
+        {
+            scanner.skip_value();
+        }
+    }
+
+    return scanner.ok();
+}
+
+std::string rate_policy::to_json_(const policy &p)
+{
+    std::string json{"{"};
+    if (p.team_percent != unset_)
+    {
+        json += "\"percent\":" + std::to_string(p.team_percent) + ",";
+    }
+    json += "\"channels\":{";
+    bool first = true;
+    for (const auto &channel : p.channels)
+    {
+        if (!first) json += ",";
+        first = false;
+        append_json_string(json, ids().str(channel.first));
+        json += ":" + std::to_string(channel.second);
+    }
+    json += "}}";
+    return json;
+}
+
+uint8_t rate_policy::percent_(const policy_ptr &p, string_view channel_id) const
+{
+    if (!p)
+    {
+        return default_percent_; // still loading
+    }
+
+    // a channel nobody has ever configured hasn't been interned
+    auto channel = p->channels.find(ids().find(channel_id));
+    if (channel != p->channels.end())
+    {
+        return channel->second;
+    }
+    return (p->team_percent != unset_) ? p->team_percent : default_percent_;
+}
+
+uint8_t rate_policy::heckle_percent(const std::string &team_id, string_view channel_id)
+{
+    auto team = ids().intern(team_id);
+    auto now = clock::now();
+    policy_ptr p;
+    {
+        std::shared_lock<std::shared_timed_mutex> lk{mutex_};
+        auto it = policies_.find(team);
+        if (it != policies_.end())
+        {
+            if (it->second.fetching || now < it->second.expires)
+            {
+                return percent_(it->second.p, channel_id);
+            }
+            p = it->second.p;
+        }
+    }
+
+    {
+        // old settings go on being used until the new ones are in
+        std::unique_lock<std::shared_timed_mutex> lk{mutex_};
+        auto &cached = policies_[team];
+        if (cached.fetching || (cached.p && now < cached.expires))
+        {
+            return percent_(cached.p, channel_id); // someone else got here first
+        }
+        cached.fetching = true;
+    }
+
+    fetch_(team, team_id);
+    return percent_(p, channel_id);
+}
+
+void rate_policy::fetch_(id_interner::id team, const std::string &team_id)
+{
+    store_.get_async(key_(team_id), [this, team, team_id](bool found, const std::string &json)
+    {
+        auto p = std::make_shared<policy>();
+        if (found && !from_json_(json, *p))
+        {
+            LOG(WARNING) << "rate_policy: can't parse settings for " << team_id << ": " << json;
+        }
+
+        std::unique_lock<std::shared_timed_mutex> lk{mutex_};
+        auto &cached = policies_[team];
+        if (!cached.fetching)
+        {
+            return; // a change has landed in the meantime, or we've been told to forget
+        }
+        cached.fetching = false;
+        if (found || !cached.p) // when it may just have failed, whatever we had before is still our best guess
+        {
+            cached.p = std::move(p);
+        }
+        cached.expires = clock::now() + (found ? clock::duration{ttl_} : clock::duration{missing_ttl_});
+    });
+}
+
+rate_policy::policy rate_policy::current_(const std::string &team_id)
+{
+    policy p;
+    std::string json;
+    if (store_.get(key_(team_id), json))
+    {
+        from_json_(json, p);
+    }
+    return p;
+}
+
+bool rate_policy::save_(const std::string &team_id, const policy &updated)
+{
+    if (!store_.set(key_(team_id), to_json_(updated)))
+    {
+        return false;
+    }
+
+    std::unique_lock<std::shared_timed_mutex> lk{mutex_};
+    policies_[ids().intern(team_id)] = {std::make_shared<const policy>(updated), clock::now() + ttl_, false};
+    return true;
+}
+
+void rate_policy::forget()
+{
+    std::unique_lock<std::shared_timed_mutex> lk{mutex_};
+    policies_.clear();
+}
+
+bool rate_policy::set_team(const std::string &team_id, unsigned percent)
+{
+    std::lock_guard<std::mutex> lk{update_mutex_};
+    auto p = current_(team_id);
+    p.team_percent = (percent > 100) ? unset_ : static_cast<int>(percent);
+    return save_(team_id, p);
+}
+
+bool rate_policy::set_channel(const std::string &team_id, const std::string &channel_id, unsigned percent)
+{
+    std::lock_guard<std::mutex> lk{update_mutex_};
+    auto p = current_(team_id);
+    if (percent > 100)
+    {
+        p.channels.erase(ids().find(channel_id));
+    }
+    else
+    {
+        p.channels[ids().intern(channel_id)] = percent;
+    }
+    return save_(team_id, p);
+}
@@ -0,0 +1,86 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#pragma once
+
+// How often we heckle, team by team and channel by channel. A channel's own setting wins over its team's, which wins
+// over the default. Each team's settings are one document in the store, and are kept in memory once they've been
+// read, for a while: they're fetched again in the background once they're old, and sooner when the store came back
+// with nothing, which may only have been because it failed. Looking a rate up never waits on the store: the first
+// time a team comes up it gets the default while its settings are fetched. Teams and channels are kept by their
+// interned IDs.
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include "beep_boop_persist.h"
+#include "id_interner.h"
+#include "json_scan.h"
+
+class rate_policy
+{
+public:
+    rate_policy(beep_boop_persist &store, uint8_t default_percent);
+
+    // The chance, out of 100, that we heckle a message in this channel.
+    uint8_t heckle_percent(const std::string &team_id, string_view channel_id);
+
+    // A percent over 100 clears the setting, so that the team or channel goes back to the default.
+    bool set_team(const std::string &team_id, unsigned percent);
+
+    bool set_channel(const std::string &team_id, const std::string &channel_id, unsigned percent);
+
+    // Drops every team's cached settings, so that they're read from the store again as they come up. For when they've
+    // been changed by someone else, like another listener shard.
+    void forget();
+
+    uint8_t default_percent() const
+    { return default_percent_; }
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    static constexpr int unset_ = -1;
+    static constexpr std::chrono::minutes ttl_{10};
+    static constexpr std::chrono::minutes missing_ttl_{1};
+
+    struct policy
+    {
+        int team_percent = unset_;
+        std::unordered_map<id_interner::id, uint8_t> channels;
+    };
+
+    using policy_ptr = std::shared_ptr<const policy>;
+
+    struct cached_policy
+    {
+        policy_ptr p; // null while a team's settings are on their way for the first time
+        clock::time_point expires;
+        bool fetching;
+    };
+
+    uint8_t percent_(const policy_ptr &p, string_view channel_id) const;
+
+    void fetch_(id_interner::id team, const std::string &team_id);
+
+    static bool from_json_(string_view json, policy &p);
+
+    static std::string to_json_(const policy &p);
+
+    // The team's settings as they are in the store right now, for changing them.
+    policy current_(const std::string &team_id);
+
+    bool save_(const std::string &team_id, const policy &updated);
+
+    beep_boop_persist &store_;
+    const uint8_t default_percent_;
+
+    std::shared_timed_mutex mutex_;
+    std::unordered_map<id_interner::id, cached_policy> policies_;
+
+    std::mutex update_mutex_; // one change at a time, so concurrent changes to one team don't undo each other
+};
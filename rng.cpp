@@ -0,0 +1,70 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#include "rng.h"
+#include <atomic>
+#include <random>
+
+static bool seeded_ = false;
+static uint64_t seed_value_ = 0;
+static std::atomic<uint64_t> next_thread_{0};
+
+static uint64_t splitmix64_(uint64_t &x)
+{
+    auto z = (x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+void xoshiro256::seed(uint64_t seed)
+{
+    for (auto &s : s_)
+    {
+        s = splitmix64_(seed);
+    }
+}
+
+void set_rng_seed(uint64_t seed)
+{
+    seeded_ = true;
+    seed_value_ = seed;
+}
+
+xoshiro256 &thread_rng()
+{
+    static thread_local xoshiro256 rng{[]
+                                       {
+                                           if (seeded_)
+                                           {
+                                               return seed_value_ + next_thread_.fetch_add(1);
+                                           }
+                                           std::random_device rd;
+                                           return (static_cast<uint64_t>(rd()) << 32) | rd();
+                                       }()};
+    return rng;
+}
+
+void reseed_thread_rng(string_view key, string_view stream)
+{
+    if (!seeded_)
+    {
+        return;
+    }
+
+    // FNV-1a over the key, a separator no event_id has, and the stream, starting from the seed
+    uint64_t hash = 0xCBF29CE484222325ull ^ seed_value_;
+    auto add = [&hash](char c)
+    { hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001B3ull; };
+    for (auto c : key) add(c);
+    add('\0');
+    for (auto c : stream) add(c);
+    thread_rng().seed(hash);
+}
+
+uint8_t d100()
+{
+    std::uniform_int_distribution<int> dis{1, 100};
+    return dis(thread_rng());
+}
@@ -0,0 +1,64 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#pragma once
+
+// Random numbers for the heckling decisions. Every thread gets its own small xoshiro256** generator, so nothing is
+// shared between threads and there's nothing to lock. Normally each one is seeded from std::random_device; with
+// set_rng_seed() the whole thing becomes deterministic, so that a load test can replay the same decisions.
+
+#include <cstdint>
+#include <limits>
+#include "json_scan.h"
+
+class xoshiro256
+{
+public:
+    using result_type = uint64_t;
+
+    explicit xoshiro256(uint64_t seed)
+    { this->seed(seed); }
+
+    static constexpr result_type min()
+    { return 0; }
+
+    static constexpr result_type max()
+    { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()()
+    {
+        auto result = rotl_(s_[1] * 5, 7) * 9;
+        auto t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl_(s_[3], 45);
+        return result;
+    }
+
+    void seed(uint64_t seed);
+
+private:
+    static uint64_t rotl_(uint64_t x, int k)
+    { return (x << k) | (x >> (64 - k)); }
+
+    uint64_t s_[4];
+};
+
+// Call before any thread draws a number.
+void set_rng_seed(uint64_t seed);
+
+// This thread's generator.
+xoshiro256 &thread_rng();
+
+// When seeded, restarts this thread's generator from the seed and key (an event_id, say), so that whatever gets
+// decided while handling that event comes out the same on every run, whichever thread it lands on. Each stream gives
+// a different, independent sequence for the same key, for decisions made at different stages of one event that
+// mustn't come out of the same draw. Otherwise this does nothing.
+void reseed_thread_rng(string_view key, string_view stream = {});
+
+// 1 through 100
+uint8_t d100();
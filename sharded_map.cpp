@@ -0,0 +1,63 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#include "sharded_map.h"
+#include <mutex>
+
+size_t sharded_map::stripe_index_(string_view key) const
+{
+    auto hash = std::hash<string_view>{}(key);
+    // the map inside the stripe buckets on the low bits, so pick the stripe with the high ones
+    return ((hash >> 32) ^ (hash >> 16)) % stripe_count_;
+}
+
+bool sharded_map::get(string_view key, std::string &value) const
+{
+    const auto &s = stripes_[stripe_index_(key)];
+
+    std::shared_lock<std::shared_timed_mutex> lk{s.mutex};
+    auto it = s.entries.find(key);
+    if (it == s.entries.end())
+    {
+        return false;
+    }
+    value = it->second->value;
+    return true;
+}
+
+void sharded_map::set(string_view key, string_view value)
+{
+    auto &s = stripes_[stripe_index_(key)];
+
+    std::unique_lock<std::shared_timed_mutex> lk{s.mutex};
+    auto it = s.entries.find(key);
+    if (it != s.entries.end())
+    {
+        it->second->value.assign(value.data(), value.size());
+        return;
+    }
+
+    std::unique_ptr<node> n{new node{key.to_string(), value.to_string()}};
+    string_view stable_key{n->key};
+    s.entries.emplace(stable_key, std::move(n));
+}
+
+bool sharded_map::erase(string_view key)
+{
+    auto &s = stripes_[stripe_index_(key)];
+
+    std::unique_lock<std::shared_timed_mutex> lk{s.mutex};
+    return s.entries.erase(key) > 0;
+}
+
+size_t sharded_map::size() const
+{
+    size_t total = 0;
+    for (const auto &s : stripes_)
+    {
+        std::shared_lock<std::shared_timed_mutex> lk{s.mutex};
+        total += s.entries.size();
+    }
+    return total;
+}
@@ -0,0 +1,63 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#pragma once
+
+// A string-to-string hash map that many threads can use at once. Keys are spread over a fixed number of stripes,
+// each with its own reader/writer lock, so threads only contend when they hit the same stripe, and readers of a
+// stripe don't block one another. Lookups take a string_view and never build a temporary std::string.
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include "json_scan.h"
+
+class sharded_map
+{
+public:
+    bool get(string_view key, std::string &value) const;
+
+    void set(string_view key, string_view value);
+
+    bool erase(string_view key);
+
+    size_t size() const;
+
+    // Visits every entry, one stripe at a time; each stripe is read-locked while it's being visited.
+    template<class F>
+    void for_each(F &&visit) const
+    {
+        for (const auto &s : stripes_)
+        {
+            std::shared_lock<std::shared_timed_mutex> lk{s.mutex};
+            for (const auto &entry : s.entries)
+            {
+                visit(entry.second->key, entry.second->value);
+            }
+        }
+    }
+
+private:
+    static constexpr size_t stripe_count_ = 64;
+
+    struct node
+    {
+        std::string key;
+        std::string value;
+    };
+
+    struct stripe
+    {
+        mutable std::shared_timed_mutex mutex;
+        std::unordered_map<string_view, std::unique_ptr<node>> entries; // views point at node::key
+        char padding[64]; // so that two busy stripes never share a cache line
+    };
+
+    size_t stripe_index_(string_view key) const;
+
+    std::array<stripe, stripe_count_> stripes_;
+};
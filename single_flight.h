@@ -0,0 +1,56 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#pragma once
+
+// Collapses concurrent calls for the same key into one. The first caller for a key runs the work; anyone who asks
+// for the same key while that is in flight waits for, and shares, its result.
+
+#include <exception>
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+template<typename T>
+class single_flight
+{
+public:
+    template<typename F>
+    T run(const std::string &key, F &&work)
+    {
+        std::unique_lock<std::mutex> lk{mutex_};
+        auto in_flight = calls_.find(key);
+        if (in_flight != calls_.end())
+        {
+            auto result = in_flight->second;
+            lk.unlock();
+            return result.get();
+        }
+
+        std::promise<T> promise;
+        auto result = promise.get_future().share();
+        calls_.emplace(key, result);
+        lk.unlock();
+
+        try
+        {
+            promise.set_value(work());
+        }
+        catch (...)
+        {
+            promise.set_exception(std::current_exception());
+        }
+
+        lk.lock();
+        calls_.erase(key);
+        lk.unlock();
+
+        return result.get();
+    }
+
+private:
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_future<T>> calls_;
+};
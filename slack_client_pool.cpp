@@ -0,0 +1,183 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#include "slack_client_pool.h"
+#include <algorithm>
+#include <cstdlib>
+#include "logging.h"
+#include "metrics.h"
+
+static std::string slack_api_url_{"https://slack.com/api/"};
+
+void set_slack_api_url(const std::string &url)
+{
+    slack_api_url_ = url;
+    if (!slack_api_url_.empty() && slack_api_url_.back() != '/')
+    {
+        slack_api_url_ += '/';
+    }
+}
+
+slack_connection::slack_connection(const std::string &bot_token) :
+        bot_token_{bot_token}
+{}
+
+struct call_metrics_
+{
+    metric_histogram &latency;
+    metric_counter &failures;
+};
+
+static call_metrics_ call_metrics_for_(const std::string &method)
+{
+    auto label = "method=\"" + method + "\"";
+    return {metrics().histogram("waldorf_slack_api_seconds", "Time taken by Slack Web API calls", label),
+            metrics().counter("waldorf_slack_api_failures_total", "Slack Web API calls that failed", label)};
+}
+
+// Only a few methods are ever called, so each gets its own metrics looked up once.
+static const call_metrics_ &call_metrics_(const std::string &method)
+{
+    static auto users_list = call_metrics_for_("users.list");
+    static auto channels_info = call_metrics_for_("channels.info");
+    static auto other = call_metrics_for_("other");
+    if (method == "users.list") return users_list;
+    if (method == "channels.info") return channels_info;
+    return other;
+}
+
+std::chrono::seconds retry_after(const cpr::Response &resp)
+{
+    auto header = resp.header.find("Retry-After");
+    auto seconds = (header == resp.header.end()) ? 0 : std::atoi(header->second.c_str());
+    return std::chrono::seconds{std::max(seconds, 1)};
+}
+
+post_result slack_connection::post_message(const slack::channel_id &channel,
+                                           const std::string &text,
+                                           std::chrono::seconds &wait)
+{
+    static auto m = call_metrics_for_("chat.postMessage");
+    scoped_timer timer{m.latency};
+
+    session_.SetUrl(cpr::Url{slack_api_url_ + "chat.postMessage"});
+    session_.SetParameters(cpr::Parameters{});
+    session_.SetPayload(cpr::Payload{{"token",   bot_token_},
+                                     {"channel", channel},
+                                     {"text",    text},
+                                     {"as_user", "true"}});
+    auto resp = session_.Post();
+    if (resp.status_code == 429)
+    {
+        m.failures.add();
+        wait = retry_after(resp);
+        return post_result::rate_limited;
+    }
+    if (resp.status_code != 200 || resp.text.find("\"ok\":true") == std::string::npos)
+    {
+        m.failures.add();
+        LOG(WARNING) << "chat.postMessage failure " << resp.status_code << " " << resp.text;
+        return post_result::failed;
+    }
+
+    return post_result::ok;
+}
+
+cpr::Response slack_connection::get(const std::string &method, cpr::Parameters parameters)
+{
+    const auto &m = call_metrics_(method);
+    scoped_timer timer{m.latency};
+
+    parameters.AddParameter({"token", bot_token_});
+    session_.SetUrl(cpr::Url{slack_api_url_ + method});
+    session_.SetParameters(std::move(parameters));
+    auto resp = session_.Get();
+    if (resp.status_code != 200 || resp.text.find("\"ok\":true") == std::string::npos) // most errors come back as 200
+    {
+        m.failures.add();
+    }
+    return resp;
+}
+
+slack_client_pool::slack_client_pool(size_t max_per_team, std::chrono::seconds idle_timeout) :
+        max_per_team_{max_per_team ? max_per_team : 1},
+        idle_timeout_{idle_timeout},
+        last_eviction_{clock::now()}
+{}
+
+slack_client_pool::lease slack_client_pool::acquire(const std::string &bot_token)
+{
+    std::unique_ptr<slack_connection> connection;
+    {
+        std::unique_lock<std::mutex> lk{mutex_};
+        auto now = clock::now();
+        if (now - last_eviction_ > idle_timeout_)
+        {
+            evict_idle_(now);
+        }
+
+        auto &team = teams_[bot_token];
+        released_.wait(lk, [&]
+        { return team.leased < max_per_team_; });
+
+        ++team.leased;
+        if (!team.idle.empty())
+        {
+            // most recently used first: it's the one most likely to still have a live connection
+            connection = std::move(team.idle.back().connection);
+            team.idle.pop_back();
+        }
+    }
+
+    if (!connection)
+    {
+        connection.reset(new slack_connection{bot_token});
+    }
+
+    return {*this, bot_token, std::move(connection)};
+}
+
+size_t slack_client_pool::idle_connections() const
+{
+    std::lock_guard<std::mutex> lk{mutex_};
+    size_t count = 0;
+    for (const auto &team : teams_)
+    {
+        count += team.second.idle.size();
+    }
+    return count;
+}
+
+void slack_client_pool::release_(const std::string &bot_token, std::unique_ptr<slack_connection> connection)
+{
+    {
+        std::lock_guard<std::mutex> lk{mutex_};
+        auto &team = teams_[bot_token];
+        --team.leased;
+        team.idle.push_back({std::move(connection), clock::now()});
+    }
+    released_.notify_all();
+}
+
+void slack_client_pool::evict_idle_(clock::time_point now)
+{
+    last_eviction_ = now;
+    for (auto team = teams_.begin(); team != teams_.end();)
+    {
+        auto &idle = team->second.idle;
+        idle.erase(std::remove_if(idle.begin(), idle.end(), [&](const idle_connection &c)
+        {
+            return now - c.since > idle_timeout_;
+        }), idle.end());
+
+        if (idle.empty() && team->second.leased == 0)
+        {
+            team = teams_.erase(team);
+        }
+        else
+        {
+            ++team;
+        }
+    }
+}
@@ -0,0 +1,132 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#pragma once
+
+// Slack clients, pooled per bot token. Each pooled connection is a cpr::Session, which keeps its curl handle (and so
+// its TCP+TLS connection) alive between calls; the calls we make on every reply, and the paged users.list scan, go
+// through it. Connections are leased out exclusively, a team can only have so many out at once, and connections that
+// sit idle for too long are closed.
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cpr/cpr.h>
+#include <slack/slack.h>
+
+// Where the Web API lives; https://slack.com/api/ unless this is a test. Call before any connection is made.
+void set_slack_api_url(const std::string &url);
+
+enum class post_result
+{
+    ok,
+    rate_limited,
+    failed,
+};
+
+// How long a 429 from Slack asked us to wait.
+std::chrono::seconds retry_after(const cpr::Response &resp);
+
+class slack_connection
+{
+public:
+    explicit slack_connection(const std::string &bot_token);
+
+    // On rate_limited, wait says how long Slack wants us to hold off.
+    post_result post_message(const slack::channel_id &channel, const std::string &text, std::chrono::seconds &wait);
+
+    // A raw Web API GET, for when we'd rather pick through the response ourselves.
+    cpr::Response get(const std::string &method, cpr::Parameters parameters);
+
+private:
+    const std::string bot_token_;
+    cpr::Session session_;
+};
+
+class slack_client_pool
+{
+public:
+    class lease
+    {
+    public:
+        lease(slack_client_pool &pool, std::string bot_token, std::unique_ptr<slack_connection> connection) :
+                pool_{&pool}, bot_token_{std::move(bot_token)}, connection_{std::move(connection)}
+        {}
+
+        lease(lease &&) = default;
+
+        // Whatever this lease holds goes back to the pool first, or its team would never get that slot back.
+        lease &operator=(lease &&other)
+        {
+            if (this != &other)
+            {
+                if (connection_)
+                {
+                    pool_->release_(bot_token_, std::move(connection_));
+                }
+                pool_ = other.pool_;
+                bot_token_ = std::move(other.bot_token_);
+                connection_ = std::move(other.connection_);
+            }
+            return *this;
+        }
+
+        ~lease()
+        {
+            if (connection_)
+            {
+                pool_->release_(bot_token_, std::move(connection_));
+            }
+        }
+
+        slack_connection *operator->() const
+        { return connection_.get(); }
+
+        slack_connection &operator*() const
+        { return *connection_; }
+
+    private:
+        slack_client_pool *pool_;
+        std::string bot_token_;
+        std::unique_ptr<slack_connection> connection_;
+    };
+
+    slack_client_pool(size_t max_per_team, std::chrono::seconds idle_timeout);
+
+    // Blocks while the team already has max_per_team connections leased out.
+    lease acquire(const std::string &bot_token);
+
+    size_t idle_connections() const;
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    struct idle_connection
+    {
+        std::unique_ptr<slack_connection> connection;
+        clock::time_point since;
+    };
+
+    struct team_pool
+    {
+        std::vector<idle_connection> idle;
+        size_t leased = 0;
+    };
+
+    void release_(const std::string &bot_token, std::unique_ptr<slack_connection> connection);
+
+    void evict_idle_(clock::time_point now);
+
+    const size_t max_per_team_;
+    const std::chrono::seconds idle_timeout_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable released_;
+    std::unordered_map<std::string, team_pool> teams_;
+    clock::time_point last_eviction_;
+};
@@ -0,0 +1,251 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#include "slack_outbox.h"
+#include <algorithm>
+#include "logging.h"
+
+constexpr int slack_outbox::max_attempts_;
+
+// Slack IDs never contain a '/', so no two team and channel pairs make the same key.
+static std::string channel_key_(const std::string &team_id, const std::string &channel)
+{
+    return team_id + '/' + channel;
+}
+
+static std::chrono::steady_clock::duration interval_(double per_second)
+{
+    using namespace std::chrono;
+    return duration_cast<steady_clock::duration>(duration<double>{1.0 / std::max(per_second, 0.001)});
+}
+
+slack_outbox::slack_outbox(slack_client_pool &clients, executor &workers, const limits &l) :
+        clients_{clients},
+        workers_{workers},
+        channel_interval_{interval_(l.channel_per_second)},
+        channel_tolerance_{channel_interval_ * (std::max<size_t>(l.channel_burst, 1) - 1)},
+        team_interval_{interval_(l.team_per_second)},
+        team_tolerance_{team_interval_ * (std::max<size_t>(l.team_burst, 1) - 1)},
+        max_delayed_{l.max_delayed},
+        next_sequence_{0},
+        last_sweep_{clock::now()},
+        stopping_{false},
+        sent_{0},
+        delayed_{0},
+        dropped_{0},
+        rate_limited_{0}
+{
+    timer_ = std::thread{&slack_outbox::run_, this};
+}
+
+slack_outbox::~slack_outbox()
+{
+    {
+        std::lock_guard<std::mutex> lk{mutex_};
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    timer_.join();
+
+    if (!queue_.empty())
+    {
+        LOG(WARNING) << "slack_outbox: dropping " << queue_.size() << " delayed messages on shutdown";
+        dropped_ += queue_.size();
+    }
+}
+
+slack_outbox::clock::time_point slack_outbox::ready_at_(const team_state &team, const channel_state &channel) const
+{
+    return std::max({team.tat - team_tolerance_, channel.tat - channel_tolerance_, team.paused_until});
+}
+
+void slack_outbox::take_(team_state &team, channel_state &channel, clock::time_point now)
+{
+    team.tat = std::max(team.tat, now) + team_interval_;
+    channel.tat = std::max(channel.tat, now) + channel_interval_;
+}
+
+bool slack_outbox::post(const slack::token &token, const std::string &channel, const std::string &text, priority p)
+{
+    message m{{}, 0, token.bot_token, token.team_id, channel, text, p, 0};
+    {
+        std::lock_guard<std::mutex> lk{mutex_};
+        auto now = clock::now();
+        auto &team = teams_[token.team_id];
+        auto &ch = channels_[channel_key_(token.team_id, channel)];
+
+        // anything already waiting for this channel goes first
+        if (ch.queued == 0 && ch.in_flight == 0 && ready_at_(team, ch) <= now)
+        {
+            take_(team, ch, now);
+            ++ch.in_flight;
+        }
+        else if (p == priority::heckle || queue_.size() >= max_delayed_)
+        {
+            ++dropped_;
+            return false;
+        }
+        else
+        {
+            ++delayed_;
+            m.due = now;
+            m.sequence = next_sequence_++;
+            schedule_(std::move(m));
+            return true;
+        }
+    }
+
+    send_(std::move(m));
+    return true;
+}
+
+size_t slack_outbox::queued()
+{
+    std::lock_guard<std::mutex> lk{mutex_};
+    return queue_.size();
+}
+
+bool slack_outbox::paused(const std::string &team_id)
+{
+    std::lock_guard<std::mutex> lk{mutex_};
+    auto team = teams_.find(team_id);
+    return (team != teams_.end()) && (team->second.paused_until > clock::now());
+}
+
+void slack_outbox::pause(const std::string &team_id, std::chrono::seconds retry_after)
+{
+    ++rate_limited_;
+    LOG(WARNING) << "slack_outbox: rate limited on team " << team_id << ", holding off for " << retry_after.count()
+                 << "s";
+
+    std::lock_guard<std::mutex> lk{mutex_};
+    auto &team = teams_[team_id];
+    team.paused_until = std::max(team.paused_until, clock::now() + retry_after);
+}
+
+void slack_outbox::schedule_(message m)
+{
+    ++channels_[channel_key_(m.team_id, m.channel)].queued;
+    queue_.push_back(std::move(m));
+    std::push_heap(queue_.begin(), queue_.end(), later_{});
+    wake_.notify_one();
+}
+
+void slack_outbox::send_(message m)
+{
+    std::chrono::seconds wait;
+    auto result = post_result::failed;
+    bool threw = false;
+    try
+    {
+        result = clients_.acquire(m.bot_token)->post_message(m.channel, m.text, wait);
+    }
+    catch (const std::exception &e)
+    {
+        // whatever happens, the channel's in_flight has to come back down below, or it never sends again
+        LOG(ERROR) << "slack_outbox: sending to " << m.channel << " threw " << e.what();
+        threw = true;
+    }
+    if (result == post_result::rate_limited)
+    {
+        pause(m.team_id, wait);
+    }
+
+    std::lock_guard<std::mutex> lk{mutex_};
+    --channels_[channel_key_(m.team_id, m.channel)].in_flight;
+    switch (result)
+    {
+        case post_result::ok:
+            ++sent_;
+            return;
+        case post_result::failed:
+            if (threw)
+            {
+                ++dropped_;
+            }
+            return; // already logged, and retrying won't help
+        case post_result::rate_limited:
+            // a retry keeps its sequence, so it still goes ahead of anything queued behind it
+            if (m.p == priority::reply && ++m.attempts < max_attempts_ && queue_.size() < max_delayed_)
+            {
+                m.due = teams_[m.team_id].paused_until;
+                schedule_(std::move(m));
+            }
+            else
+            {
+                ++dropped_;
+            }
+            return;
+    }
+}
+
+void slack_outbox::run_()
+{
+    std::unique_lock<std::mutex> lk{mutex_};
+    while (!stopping_)
+    {
+        auto now = clock::now();
+        if (now - last_sweep_ > std::chrono::minutes{1})
+        {
+            sweep_(now);
+        }
+
+        if (queue_.empty())
+        {
+            wake_.wait_for(lk, std::chrono::minutes{1});
+            continue;
+        }
+        if (queue_.front().due > now)
+        {
+            wake_.wait_until(lk, queue_.front().due);
+            continue;
+        }
+
+        std::pop_heap(queue_.begin(), queue_.end(), later_{});
+        auto m = std::move(queue_.back());
+        queue_.pop_back();
+
+        auto &team = teams_[m.team_id];
+        auto &ch = channels_[channel_key_(m.team_id, m.channel)];
+        auto ready = ready_at_(team, ch);
+        if (ch.in_flight > 0 || ready > now)
+        {
+            // not yet; it keeps its sequence, so it still goes ahead of anything queued behind it
+            --ch.queued;
+            m.due = std::max(ready, now + std::chrono::milliseconds{10});
+            schedule_(std::move(m));
+            continue;
+        }
+
+        take_(team, ch, now);
+        --ch.queued;
+        ++ch.in_flight;
+        lk.unlock();
+
+        executor::task t = [this, m]
+        { send_(m); };
+        if (!workers_.try_submit(t))
+        {
+            send_(std::move(m));
+        }
+
+        lk.lock();
+    }
+}
+
+void slack_outbox::sweep_(clock::time_point now)
+{
+    // forget about teams and channels that have been quiet long enough that their budget is full again
+    last_sweep_ = now;
+    for (auto it = channels_.begin(); it != channels_.end();)
+    {
+        auto idle = it->second.queued == 0 && it->second.in_flight == 0 && it->second.tat <= now;
+        it = idle ? channels_.erase(it) : std::next(it);
+    }
+    for (auto it = teams_.begin(); it != teams_.end();)
+    {
+        auto idle = it->second.tat <= now && it->second.paused_until <= now;
+        it = idle ? teams_.erase(it) : std::next(it);
+    }
+}
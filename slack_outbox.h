@@ -0,0 +1,147 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#pragma once
+
+// Everything we post to Slack goes through here, so that we stay inside its rate limits instead of being throttled
+// and losing replies. Each team, and each channel within a team, has a token bucket (kept as a GCRA "theoretical
+// arrival time", which is the same thing in one number). A message goes out right away on the calling thread when
+// both have budget. Otherwise a reply waits in a delayed queue until they do, and a heckle, which nobody is waiting
+// for, is simply dropped. When Slack answers 429 anyway, the whole team is paused for as long as its Retry-After says
+// and the message is queued again. Nothing ever sleeps on a worker: a single timer thread watches the delayed queue
+// and hands messages back to the executor as they come due. Messages to one channel always go out in order.
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <slack/slack.h>
+#include "executor.h"
+#include "slack_client_pool.h"
+
+class slack_outbox
+{
+public:
+    enum class priority
+    {
+        heckle,
+        reply,
+    };
+
+    struct limits
+    {
+        double channel_per_second;
+        size_t channel_burst;
+        double team_per_second;
+        size_t team_burst;
+        size_t max_delayed;
+    };
+
+    slack_outbox(slack_client_pool &clients, executor &workers, const limits &l);
+
+    ~slack_outbox();
+
+    // Never waits. Returns false if the message was dropped.
+    bool post(const slack::token &token, const std::string &channel, const std::string &text, priority p);
+
+    // For the other Web API calls we make: whether Slack has told us to back off this team, and passing on a 429.
+    bool paused(const std::string &team_id);
+
+    void pause(const std::string &team_id, std::chrono::seconds retry_after);
+
+    // Messages waiting in the delayed queue right now.
+    size_t queued();
+
+    uint64_t sent() const
+    { return sent_.load(std::memory_order_relaxed); }
+
+    uint64_t delayed() const
+    { return delayed_.load(std::memory_order_relaxed); }
+
+    uint64_t dropped() const
+    { return dropped_.load(std::memory_order_relaxed); }
+
+    uint64_t rate_limited() const
+    { return rate_limited_.load(std::memory_order_relaxed); }
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    static constexpr int max_attempts_ = 3;
+
+    struct team_state
+    {
+        clock::time_point tat;
+        clock::time_point paused_until;
+    };
+
+    struct channel_state
+    {
+        clock::time_point tat;
+        size_t queued = 0;    // waiting in the delayed queue
+        size_t in_flight = 0; // being sent right now
+    };
+
+    struct message
+    {
+        clock::time_point due;
+        uint64_t sequence; // breaks ties in due, so a channel's messages stay in order
+        std::string bot_token;
+        std::string team_id;
+        std::string channel;
+        std::string text;
+        priority p;
+        int attempts;
+    };
+
+    // the soonest message at the front of the heap
+    struct later_
+    {
+        bool operator()(const message &a, const message &b) const
+        { return (a.due != b.due) ? (a.due > b.due) : (a.sequence > b.sequence); }
+    };
+
+    // With mutex_ held. The earliest the team and channel will both have budget for another message.
+    clock::time_point ready_at_(const team_state &team, const channel_state &channel) const;
+
+    // With mutex_ held, once ready_at_ has come.
+    void take_(team_state &team, channel_state &channel, clock::time_point now);
+
+    // With mutex_ held.
+    void schedule_(message m);
+
+    void send_(message m);
+
+    void run_();
+
+    void sweep_(clock::time_point now);
+
+    slack_client_pool &clients_;
+    executor &workers_;
+
+    const clock::duration channel_interval_;
+    const clock::duration channel_tolerance_;
+    const clock::duration team_interval_;
+    const clock::duration team_tolerance_;
+    const size_t max_delayed_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::unordered_map<std::string, team_state> teams_;
+    std::unordered_map<std::string, channel_state> channels_; // keyed on team_id/channel
+    std::vector<message> queue_; // a heap, ordered by later_
+    uint64_t next_sequence_;
+    clock::time_point last_sweep_;
+    bool stopping_;
+    std::thread timer_;
+
+    std::atomic<uint64_t> sent_;
+    std::atomic<uint64_t> delayed_;
+    std::atomic<uint64_t> dropped_;
+    std::atomic<uint64_t> rate_limited_;
+};
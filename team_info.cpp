@@ -2,37 +2,142 @@
 // Created by D.E. Goodman-Wilson on 9/26/16.
 //
 
-#include <sstream>
 #include "team_info.h"
-#include <json/json.h>
 
-std::string team_info::to_json()
+// Binary layout: version byte, then each field as a varint length followed by its bytes.
+static constexpr char binary_version_ = '\x01';
+
+std::string team_info::to_json() const
 {
-    Json::Value res;
-    res["companion_user_id"] = companion_user_id;
-    res["companion_bot_id"] = companion_bot_id;
-    std::stringstream out;
-    out << res;
-    return out.str();
+    std::string out;
+    to_json(out);
+    return out;
 }
 
-team_info from_json(const std::string &str)
+void team_info::to_json(std::string &out) const
 {
-    team_info info;
-    Json::Value obj;
-    Json::Reader reader;
-    bool parsed_success = reader.parse(str, obj, false);
-    if(parsed_success)
+    auto user_id = companion_user_id();
+    auto bot_id = companion_bot_id();
+    out.reserve(out.size() + 48 + user_id.size() + bot_id.size());
+    out += "{\"companion_bot_id\":";
+    append_json_string(out, bot_id);
+    out += ",\"companion_user_id\":";
+    append_json_string(out, user_id);
+    out += '}';
+}
+
+static void append_field_(std::string &out, string_view field)
+{
+    auto len = field.size();
+    while (len >= 0x80)
+    {
+        out += static_cast<char>((len & 0x7F) | 0x80);
+        len >>= 7;
+    }
+    out += static_cast<char>(len);
+    out.append(field.data(), field.size());
+}
+
+void team_info::to_binary(std::string &out) const
+{
+    out += binary_version_;
+    append_field_(out, companion_user_id());
+    append_field_(out, companion_bot_id());
+}
+
+std::string encode_team_info(const team_info &info, bool binary)
+{
+    std::string out;
+    if (binary)
     {
-        if (obj["companion_user_id"].isString())
+        info.to_binary(out);
+    }
+    else
+    {
+        info.to_json(out);
+    }
+    return out;
+}
+
+static bool read_field_(string_view str, size_t &pos, id_interner::id &field)
+{
+    size_t len = 0;
+    for (int shift = 0; ; shift += 7)
+    {
+        if (pos >= str.size() || shift > 28)
         {
-            info.companion_user_id = obj["companion_user_id"].asString();
+            return false;
         }
-        if (obj["companion_bot_id"].isString())
+        auto byte = static_cast<uint8_t>(str[pos++]);
+        len |= static_cast<size_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
         {
-            info.companion_bot_id = obj["companion_bot_id"].asString();
+            break;
         }
     }
 
+    if (pos + len > str.size())
+    {
+        return false;
+    }
+    field = ids().intern(string_view{str.data() + pos, len});
+    pos += len;
+    return true;
+}
+
+static bool from_binary_(string_view str, team_info &info)
+{
+    size_t pos = 1;
+    return read_field_(str, pos, info.companion_user) && read_field_(str, pos, info.companion_bot);
+}
+
+static bool from_json_(string_view str, team_info &info)
+{
+    json_scanner scanner{str};
+    if (!scanner.enter_object())
+    {
+        return false;
+    }
+
+    string_view key;
+    std::string value;
+    while (scanner.next_key(key))
+    {
+        if (key == "companion_user_id" && scanner.peek() == '"')
+        {
+            scanner.read_string(value);
+            info.companion_user = ids().intern(value);
+        }
+        else if (key == "companion_bot_id" && scanner.peek() == '"')
+        {
+            scanner.read_string(value);
+            info.companion_bot = ids().intern(value);
+        }
+        else
+        {
+            scanner.skip_value();
+        }
+    }
+
+    return scanner.ok();
+}
+
+team_info from_json(const std::string &str)
+{
+    team_info info;
+    if (!from_json_(str, info))
+    {
+        return {};
+    }
+
     return info;
-}
\ No newline at end of file
+}
+
+bool decode_team_info(string_view str, team_info &info)
+{
+    if (!str.empty() && str[0] == binary_version_)
+    {
+        return from_binary_(str, info);
+    }
+    return from_json_(str, info);
+}
@@ -7,13 +7,43 @@
 #include <vector>
 #include <string>
 #include <slack/slack.h>
+#include "id_interner.h"
+#include "json_scan.h"
 
+// The companion's IDs are interned, so a team_info is two integers, and checking whether a message came from the
+// companion is an integer compare.
 struct team_info
 {
-    std::string to_json();
+    team_info() = default;
 
-    slack::user_id companion_user_id;
-    slack::bot_id companion_bot_id;
+    team_info(string_view user_id, string_view bot_id) :
+            companion_user{ids().intern(user_id)}, companion_bot{ids().intern(bot_id)}
+    {}
+
+    string_view companion_user_id() const
+    { return ids().str(companion_user); }
+
+    string_view companion_bot_id() const
+    { return ids().str(companion_bot); }
+
+    bool is_companion(id_interner::id sender) const
+    { return sender != id_interner::none && (sender == companion_user || sender == companion_bot); }
+
+    std::string to_json() const;
+
+    // Appends to a buffer the caller can reuse, rather than returning a fresh string.
+    void to_json(std::string &out) const;
+
+    // A compact binary encoding, for stores that only we read (the local log and snapshots).
+    void to_binary(std::string &out) const;
+
+    id_interner::id companion_user = id_interner::none;
+    id_interner::id companion_bot = id_interner::none;
 };
 
-team_info from_json(const std::string &str);
\ No newline at end of file
+team_info from_json(const std::string &str);
+
+std::string encode_team_info(const team_info &info, bool binary);
+
+// Accepts either encoding. Returns false if it's neither.
+bool decode_team_info(string_view str, team_info &info);
@@ -0,0 +1,248 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#include "team_info_cache.h"
+
+constexpr uint32_t team_info_cache::nil_;
+constexpr size_t team_info_cache::generation_slots_;
+constexpr uint64_t team_info_cache::any_generation;
+
+team_info_cache::team_info_cache(size_t capacity, std::chrono::seconds ttl, std::chrono::seconds absent_ttl) :
+        capacity_{capacity ? capacity : 1},
+        ttl_{ttl},
+        absent_ttl_{absent_ttl},
+        newest_{nil_},
+        oldest_{nil_},
+        free_{nil_},
+        size_{0},
+        generations_{},
+        hits_{0},
+        misses_{0},
+        absent_hits_{0}
+{}
+
+uint32_t team_info_cache::find_(id_interner::id team) const
+{
+    if (index_.empty() || team == id_interner::none)
+    {
+        return nil_;
+    }
+
+    auto mask = index_.size() - 1;
+    for (auto i = slot_(team); index_[i] != 0; i = (i + 1) & mask)
+    {
+        if (entries_[index_[i] - 1].team == team) return index_[i] - 1;
+    }
+    return nil_;
+}
+
+void team_info_cache::unlink_(uint32_t i)
+{
+    auto &e = entries_[i];
+    (e.newer == nil_ ? newest_ : entries_[e.newer].older) = e.older;
+    (e.older == nil_ ? oldest_ : entries_[e.older].newer) = e.newer;
+}
+
+void team_info_cache::push_front_(uint32_t i)
+{
+    auto &e = entries_[i];
+    e.newer = nil_;
+    e.older = newest_;
+    (newest_ == nil_ ? oldest_ : entries_[newest_].newer) = i;
+    newest_ = i;
+}
+
+void team_info_cache::remove_(uint32_t i)
+{
+    auto mask = index_.size() - 1;
+    auto hole = slot_(entries_[i].team);
+    while (index_[hole] != i + 1)
+    {
+        hole = (hole + 1) & mask;
+    }
+
+    // shift later entries of the probe run back into the hole, so lookups never stop short
+    for (auto j = (hole + 1) & mask; index_[j] != 0; j = (j + 1) & mask)
+    {
+        auto home = slot_(entries_[index_[j] - 1].team);
+        if (((j - home) & mask) >= ((j - hole) & mask))
+        {
+            index_[hole] = index_[j];
+            hole = j;
+        }
+    }
+    index_[hole] = 0;
+
+    unlink_(i);
+    entries_[i].team = id_interner::none;
+    entries_[i].older = free_;
+    free_ = i;
+    --size_;
+}
+
+void team_info_cache::grow_index_()
+{
+    index_.assign(index_.empty() ? 64 : index_.size() * 2, 0);
+    auto mask = index_.size() - 1;
+    for (auto i = newest_; i != nil_; i = entries_[i].older)
+    {
+        auto slot = slot_(entries_[i].team);
+        while (index_[slot] != 0)
+        {
+            slot = (slot + 1) & mask;
+        }
+        index_[slot] = i + 1;
+    }
+}
+
+team_info_cache::result team_info_cache::get(const std::string &team_id, team_info &info)
+{
+    auto team = ids().find(team_id);
+
+    std::lock_guard<std::mutex> lk{mutex_};
+
+    auto i = find_(team);
+    if (i == nil_)
+    {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return result::miss;
+    }
+
+    if (clock::now() >= entries_[i].expires)
+    {
+        remove_(i);
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return result::miss;
+    }
+
+    unlink_(i);
+    push_front_(i);
+    if (entries_[i].absent)
+    {
+        absent_hits_.fetch_add(1, std::memory_order_relaxed);
+        return result::absent;
+    }
+
+    info = entries_[i].info;
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return result::found;
+}
+
+uint64_t team_info_cache::generation(const std::string &team_id) const
+{
+    // interned now, so that an erase from here on can find the team to move its generation on
+    auto team = ids().intern(team_id);
+
+    std::lock_guard<std::mutex> lk{mutex_};
+    return generation_(team);
+}
+
+void team_info_cache::put(const std::string &team_id, const team_info &info, uint64_t generation)
+{
+    insert_(ids().intern(team_id), info, false, ttl_, generation);
+}
+
+void team_info_cache::put_absent(const std::string &team_id, uint64_t generation)
+{
+    insert_(ids().intern(team_id), {}, true, absent_ttl_, generation);
+}
+
+void team_info_cache::insert_(id_interner::id team,
+                              const team_info &info,
+                              bool absent,
+                              clock::duration ttl,
+                              uint64_t generation)
+{
+    std::lock_guard<std::mutex> lk{mutex_};
+
+    if (generation != any_generation && generation != generation_(team))
+    {
+        return; // erased while this was being looked up
+    }
+
+    auto expires = clock::now() + ttl;
+    auto i = find_(team);
+    if (i != nil_)
+    {
+        entries_[i].info = info;
+        entries_[i].absent = absent;
+        entries_[i].expires = expires;
+        unlink_(i);
+        push_front_(i);
+        return;
+    }
+
+    if (size_ >= capacity_)
+    {
+        remove_(oldest_);
+    }
+
+    if (free_ != nil_)
+    {
+        i = free_;
+        free_ = entries_[i].older;
+    }
+    else
+    {
+        i = static_cast<uint32_t>(entries_.size());
+        entries_.emplace_back();
+    }
+    entries_[i].team = team;
+    entries_[i].info = info;
+    entries_[i].absent = absent;
+    entries_[i].expires = expires;
+    push_front_(i);
+    ++size_;
+
+    if (size_ * 2 > index_.size())
+    {
+        grow_index_(); // and it goes in along with everything else
+        return;
+    }
+    auto mask = index_.size() - 1;
+    auto slot = slot_(team);
+    while (index_[slot] != 0)
+    {
+        slot = (slot + 1) & mask;
+    }
+    index_[slot] = i + 1;
+}
+
+void team_info_cache::erase(const std::string &team_id)
+{
+    auto team = ids().find(team_id);
+    if (team == id_interner::none)
+    {
+        return; // never cached, and nobody has started looking it up
+    }
+
+    std::lock_guard<std::mutex> lk{mutex_};
+
+    ++generation_(team);
+    auto i = find_(team);
+    if (i != nil_)
+    {
+        remove_(i);
+    }
+}
+
+size_t team_info_cache::size() const
+{
+    std::lock_guard<std::mutex> lk{mutex_};
+    return size_;
+}
+
+void team_info_cache::for_each(const std::function<void(string_view, const team_info &, bool)> &f) const
+{
+    std::lock_guard<std::mutex> lk{mutex_};
+
+    auto now = clock::now();
+    for (auto i = newest_; i != nil_; i = entries_[i].older)
+    {
+        if (now < entries_[i].expires)
+        {
+            f(ids().str(entries_[i].team), entries_[i].info, entries_[i].absent);
+        }
+    }
+}
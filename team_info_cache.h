@@ -0,0 +1,122 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#pragma once
+
+// Decoded team_info, kept in process so that we don't go back to the KV store (and back through the JSON parser)
+// for every message. Entries expire after a fixed TTL, and once the cache is full the least recently used team is
+// dropped to make room. We also remember, for a shorter while, teams where we looked and found no Statler, so that
+// a team without it isn't rescanned on every message. Teams are keyed on their interned IDs, so an entry is a few
+// integers and a timestamp, and the entries sit in one flat array rather than a node apiece.
+//
+// A lookup that's slower than an erase mustn't put back what the erase threw out, so each team has a generation that
+// erase moves on. A lookup reads it before it starts and hands it to put() or put_absent(), which drop the result if
+// the team has been erased since. Generations are kept in a fixed number of slots that teams share, so an erase may
+// also cost another team a cached result now and then, but never a stale one.
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "team_info.h"
+
+class team_info_cache
+{
+public:
+    enum class result
+    {
+        miss,
+        found,
+        absent,
+    };
+
+    team_info_cache(size_t capacity, std::chrono::seconds ttl, std::chrono::seconds absent_ttl);
+
+    static constexpr uint64_t any_generation = UINT64_MAX;
+
+    result get(const std::string &team_id, team_info &info);
+
+    uint64_t generation(const std::string &team_id) const;
+
+    void put(const std::string &team_id, const team_info &info, uint64_t generation = any_generation);
+
+    // Remember that this team has no companion installed.
+    void put_absent(const std::string &team_id, uint64_t generation = any_generation);
+
+    void erase(const std::string &team_id);
+
+    size_t size() const;
+
+    // Every entry that hasn't expired, most recently used first. Called with the cache locked, so keep it quick.
+    void for_each(const std::function<void(string_view team_id, const team_info &info, bool absent)> &f) const;
+
+    uint64_t hits() const
+    { return hits_.load(std::memory_order_relaxed); }
+
+    uint64_t misses() const
+    { return misses_.load(std::memory_order_relaxed); }
+
+    uint64_t absent_hits() const
+    { return absent_hits_.load(std::memory_order_relaxed); }
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    static constexpr uint32_t nil_ = UINT32_MAX;
+    static constexpr size_t generation_slots_ = 1024;
+
+    // 32 bytes. Entries live side by side in entries_, and link to one another by index, most recently used first.
+    struct entry
+    {
+        id_interner::id team;
+        team_info info;
+        uint32_t newer;
+        uint32_t older; // also links the free list
+        bool absent;
+        clock::time_point expires;
+    };
+
+    const size_t capacity_;
+    const std::chrono::seconds ttl_;
+    const std::chrono::seconds absent_ttl_;
+
+    mutable std::mutex mutex_;
+    std::vector<entry> entries_;
+    uint32_t newest_;
+    uint32_t oldest_;
+    uint32_t free_;
+    size_t size_;
+    std::vector<uint32_t> index_; // open addressing, by team; each slot is an index into entries_ plus one, or 0
+    std::array<uint64_t, generation_slots_> generations_; // by team, hashed
+
+    std::atomic<uint64_t> hits_;
+    std::atomic<uint64_t> misses_;
+    std::atomic<uint64_t> absent_hits_;
+
+    // All of these with mutex_ held.
+    size_t slot_(id_interner::id team) const
+    { return (team * 2654435761u) & (index_.size() - 1); }
+
+    uint32_t find_(id_interner::id team) const;
+
+    uint64_t &generation_(id_interner::id team)
+    { return generations_[(team * 2654435761u) & (generation_slots_ - 1)]; }
+
+    const uint64_t &generation_(id_interner::id team) const
+    { return generations_[(team * 2654435761u) & (generation_slots_ - 1)]; }
+
+    void unlink_(uint32_t i);
+
+    void push_front_(uint32_t i);
+
+    void remove_(uint32_t i);
+
+    void grow_index_();
+
+    void insert_(id_interner::id team, const team_info &info, bool absent, clock::duration ttl, uint64_t generation);
+};
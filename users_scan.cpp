@@ -0,0 +1,121 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#include "users_scan.h"
+
+static bool scan_member_(json_scanner &scanner, string_view app_id, team_info &info)
+{
+    string_view id, member_app_id, bot_id;
+    bool is_bot = false;
+
+    if (!scanner.enter_object())
+    {
+        return false;
+    }
+
+    string_view key;
+    while (scanner.next_key(key))
+    {
+        if (key == "id")
+        {
+            scanner.read_raw_string(id);
+        }
+        else if (key == "is_bot")
+        {
+            scanner.read_bool(is_bot);
+        }
+        else if (key == "profile" && scanner.peek() == '{')
+        {
+            scanner.enter_object();
+            string_view profile_key;
+            while (scanner.next_key(profile_key))
+            {
+                if (profile_key == "api_app_id" && scanner.peek() == '"')
+                {
+                    scanner.read_raw_string(member_app_id);
+                }
+                else if (profile_key == "bot_id" && scanner.peek() == '"')
+                {
+                    scanner.read_raw_string(bot_id);
+                }
+                else
+                {
+                    scanner.skip_value();
+                }
+            }
+        }
+        else
+        {
+            scanner.skip_value();
+        }
+    }
+
+    if (scanner.ok() && is_bot && member_app_id == app_id)
+    {
+        info = team_info{id, bot_id};
+        return true;
+    }
+
+    return false;
+}
+
+users_page_result scan_users_page(string_view body, string_view app_id, team_info &info, std::string &next_cursor)
+{
+    json_scanner scanner{body};
+    next_cursor.clear();
+
+    if (!scanner.enter_object())
+    {
+        return users_page_result::error;
+    }
+
+    bool ok = false;
+    string_view key;
+    while (scanner.next_key(key))
+    {
+        if (key == "ok")
+        {
+            scanner.read_bool(ok);
+        }
+        else if (key == "members" && scanner.peek() == '[')
+        {
+            scanner.enter_array();
+            while (scanner.next_element())
+            {
+                if (scan_member_(scanner, app_id, info))
+                {
+                    return users_page_result::found;
+                }
+            }
+        }
+        else if (key == "response_metadata" && scanner.peek() == '{')
+        {
+            scanner.enter_object();
+            string_view metadata_key;
+            while (scanner.next_key(metadata_key))
+            {
+                if (metadata_key == "next_cursor" && scanner.peek() == '"')
+                {
+                    scanner.read_string(next_cursor);
+                }
+                else
+                {
+                    scanner.skip_value();
+                }
+            }
+        }
+        else
+        {
+            scanner.skip_value();
+        }
+    }
+
+    if (!scanner.ok() || !ok)
+    {
+        next_cursor.clear();
+        return users_page_result::error;
+    }
+
+    return users_page_result::not_found;
+}
@@ -0,0 +1,23 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#pragma once
+
+// Picks a companion bot out of a page of users.list without materializing the member directory. Only id, is_bot and
+// the profile's api_app_id and bot_id are looked at; everything else is skipped over in place, and the scan stops at
+// the first match.
+
+#include <string>
+#include "json_scan.h"
+#include "team_info.h"
+
+enum class users_page_result
+{
+    found,
+    not_found,
+    error,
+};
+
+// On not_found, next_cursor is left holding the cursor for the following page, or empty if this was the last one.
+users_page_result scan_users_page(string_view body, string_view app_id, team_info &info, std::string &next_cursor);
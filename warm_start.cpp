@@ -0,0 +1,269 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#include "warm_start.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <unistd.h>
+#include "logging.h"
+
+// Layout: the magic, then a varint count of teams, each as its ID, an absent flag byte and (unless absent) its binary
+// team_info; then a varint count of channels, each as team ID, channel ID, a varint count of members and the members.
+// Every string is a varint length followed by its bytes.
+static const std::string magic_{"waldorf-snapshot-1\n"};
+
+static constexpr size_t refresh_batch_ = 100;
+
+static void append_varint_(std::string &out, size_t n)
+{
+    while (n >= 0x80)
+    {
+        out += static_cast<char>((n & 0x7F) | 0x80);
+        n >>= 7;
+    }
+    out += static_cast<char>(n);
+}
+
+static void append_string_(std::string &out, string_view str)
+{
+    append_varint_(out, str.size());
+    out.append(str.data(), str.size());
+}
+
+static bool read_varint_(const std::string &in, size_t &pos, size_t &n)
+{
+    n = 0;
+    for (int shift = 0; pos < in.size() && shift <= 56; shift += 7)
+    {
+        auto byte = static_cast<uint8_t>(in[pos++]);
+        n |= static_cast<size_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool read_string_(const std::string &in, size_t &pos, string_view &str)
+{
+    size_t len;
+    if (!read_varint_(in, pos, len) || len > in.size() - pos)
+    {
+        return false;
+    }
+    str = string_view{in.data() + pos, len};
+    pos += len;
+    return true;
+}
+
+static bool write_synced_(const std::string &path, const std::string &data)
+{
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    bool ok = true;
+    for (size_t done = 0; ok && done < data.size();)
+    {
+        auto n = ::write(fd, data.data() + done, data.size() - done);
+        if (n < 0 && errno == EINTR) continue;
+        ok = n > 0;
+        done += ok ? n : 0;
+    }
+    ok = ok && (::fsync(fd) == 0);
+    ::close(fd);
+    return ok;
+}
+
+bool save_snapshot(const std::string &path, const team_info_cache &teams, const channel_membership &channels)
+{
+    std::string teams_out;
+    size_t team_count = 0;
+    teams.for_each([&](string_view team_id, const team_info &info, bool absent)
+    {
+        append_string_(teams_out, team_id);
+        teams_out += absent ? '\x01' : '\x00';
+        if (!absent)
+        {
+            std::string encoded;
+            info.to_binary(encoded);
+            append_string_(teams_out, encoded);
+        }
+        ++team_count;
+    });
+
+    std::string channels_out;
+    size_t channel_count = 0;
+    channels.for_each([&](string_view team_id, string_view channel_id, const std::vector<string_view> &members)
+    {
+        append_string_(channels_out, team_id);
+        append_string_(channels_out, channel_id);
+        append_varint_(channels_out, members.size());
+        for (const auto &member : members)
+        {
+            append_string_(channels_out, member);
+        }
+        ++channel_count;
+    });
+
+    std::string out{magic_};
+    append_varint_(out, team_count);
+    out += teams_out;
+    append_varint_(out, channel_count);
+    out += channels_out;
+
+    // written alongside, synced, and renamed into place, so a crash part way through leaves the last good snapshot
+    // alone rather than an empty one in its place
+    auto tmp_path = path + ".tmp";
+    if (!write_synced_(tmp_path, out))
+    {
+        LOG(WARNING) << "Couldn't write snapshot to " << tmp_path << ": " << std::strerror(errno);
+        ::unlink(tmp_path.c_str());
+        return false;
+    }
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0)
+    {
+        LOG(WARNING) << "Couldn't move snapshot into place at " << path;
+        return false;
+    }
+
+    LOG(INFO) << "Snapshot of " << team_count << " teams and " << channel_count << " channels (" << out.size()
+              << " bytes) written to " << path;
+    return true;
+}
+
+bool load_snapshot(const std::string &path,
+                   team_info_cache &teams,
+                   channel_membership &channels,
+                   std::vector<std::string> &known_teams)
+{
+    std::ifstream file{path, std::ios::binary};
+    if (!file)
+    {
+        LOG(INFO) << "No snapshot at " << path << ", starting cold";
+        return false;
+    }
+    std::string in{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+
+    if (in.compare(0, magic_.size(), magic_) != 0)
+    {
+        LOG(WARNING) << "Ignoring snapshot at " << path << ", it isn't one of ours";
+        return false;
+    }
+
+    // Everything is read before anything goes into the caches, so a damaged file changes nothing.
+    struct team_entry
+    {
+        string_view team_id;
+        team_info info;
+        bool absent;
+    };
+    struct channel_entry
+    {
+        string_view team_id;
+        string_view channel_id;
+        std::vector<string_view> members;
+    };
+    std::vector<team_entry> team_entries;
+    std::vector<channel_entry> channel_entries;
+
+    size_t pos = magic_.size();
+    size_t count;
+    bool ok = read_varint_(in, pos, count);
+    for (size_t i = 0; ok && i < count; ++i)
+    {
+        team_entry e{};
+        ok = read_string_(in, pos, e.team_id) && pos < in.size();
+        if (!ok) break;
+        e.absent = (in[pos++] != '\x00');
+        string_view encoded;
+        ok = e.absent || (read_string_(in, pos, encoded) && decode_team_info(encoded, e.info));
+        team_entries.push_back(std::move(e));
+    }
+
+    ok = ok && read_varint_(in, pos, count);
+    for (size_t i = 0; ok && i < count; ++i)
+    {
+        channel_entry e;
+        size_t members;
+        ok = read_string_(in, pos, e.team_id) && read_string_(in, pos, e.channel_id) && read_varint_(in, pos, members);
+        for (size_t j = 0; ok && j < members; ++j)
+        {
+            string_view member;
+            ok = read_string_(in, pos, member);
+            e.members.push_back(member);
+        }
+        channel_entries.push_back(std::move(e));
+    }
+
+    if (!ok || pos != in.size())
+    {
+        LOG(WARNING) << "Ignoring snapshot at " << path << ", it's damaged";
+        return false;
+    }
+
+    // most recently used went out first, so in reverse it comes back in the same order
+    for (auto it = team_entries.rbegin(); it != team_entries.rend(); ++it)
+    {
+        auto team_id = it->team_id.to_string();
+        if (it->absent)
+        {
+            teams.put_absent(team_id);
+        }
+        else
+        {
+            teams.put(team_id, it->info);
+            known_teams.push_back(std::move(team_id));
+        }
+    }
+    for (const auto &e : channel_entries)
+    {
+        channels.fill(e.team_id, e.channel_id, e.members);
+    }
+
+    LOG(INFO) << "Loaded " << team_entries.size() << " teams and " << channel_entries.size() << " channels from "
+              << path;
+    return true;
+}
+
+size_t refresh_teams(const beep_boop_persist &store,
+                     team_info_cache &teams,
+                     const std::vector<std::string> &known_teams,
+                     std::chrono::steady_clock::time_point deadline)
+{
+    std::vector<std::future<std::map<std::string, std::string>>> batches;
+    for (size_t i = 0; i < known_teams.size(); i += refresh_batch_)
+    {
+        auto end = std::min(i + refresh_batch_, known_teams.size());
+        batches.push_back(store.mget_async({known_teams.begin() + i, known_teams.begin() + end}));
+    }
+
+    size_t refreshed = 0;
+    for (auto &batch : batches)
+    {
+        if (batch.wait_until(deadline) != std::future_status::ready)
+        {
+            LOG(WARNING) << "Gave up waiting on the store to refresh teams; the rest will be read as they're needed";
+            break;
+        }
+        for (const auto &kv : batch.get())
+        {
+            team_info info;
+            if (decode_team_info(kv.second, info))
+            {
+                teams.put(kv.first, info);
+                ++refreshed;
+            }
+        }
+    }
+    return refreshed;
+}
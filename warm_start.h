@@ -0,0 +1,34 @@
+//
+// Created by D.E. Goodman-Wilson on 10/17/26.
+//
+
+#pragma once
+
+// What we know about teams and channels, written to a local file on the way down and read back on the way up, so that
+// a restart doesn't send every active team back to the KV store and users.list at once. The snapshot is a compact
+// binary file that only we read. One that is damaged, or was written by a different version, is ignored rather than
+// half-trusted; the caches just start cold.
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "beep_boop_persist.h"
+#include "channel_membership.h"
+#include "team_info_cache.h"
+
+bool save_snapshot(const std::string &path, const team_info_cache &teams, const channel_membership &channels);
+
+// Fills the caches from the snapshot at path. known_teams gets every team that had a companion installed, for
+// refresh_teams().
+bool load_snapshot(const std::string &path,
+                   team_info_cache &teams,
+                   channel_membership &channels,
+                   std::vector<std::string> &known_teams);
+
+// Reads known_teams back from the store, a batch per round trip with the batches in flight at once, so that anything
+// that changed while we were down replaces what the snapshot had. Stops waiting at deadline. Returns how many teams
+// were refreshed.
+size_t refresh_teams(const beep_boop_persist &store,
+                     team_info_cache &teams,
+                     const std::vector<std::string> &known_teams,
+                     std::chrono::steady_clock::time_point deadline);